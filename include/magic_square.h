@@ -5,24 +5,111 @@
 #ifndef PERFECT_MAGIC_SQUARE_MAGIC_SQUARE_H
 #define PERFECT_MAGIC_SQUARE_MAGIC_SQUARE_H
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+// Range of square dimensions the application is instantiated for
+const int MIN_DIMENSION = 3;
+const int MAX_DIMENSION = 9;
+
 // Calculate the magic sum of a square of given size
-#define MAGIC_SUM(square_size) ((square_size * (square_size * square_size + 1)) / 2)
+constexpr int magicSum(int size) { return (size * (size * size + 1)) / 2; }
+
+// Narrowest unsigned type holding every cell value 1..N*N, line sums are accumulated in int
+template<int N>
+using Cell = std::conditional_t<(N <= 15), std::uint8_t, std::uint16_t>;
+
+// Raw row-major cells of a single square
+template<int N>
+using Genome = std::array<Cell<N>, N * N>;
+
+// Zobrist keys per cell and value 0..N*N generated with splitmix64, the empty value 0 hashes to 0
+template<int N>
+inline constexpr auto ZOBRIST_KEYS = [] {
+    std::array<std::uint64_t, N * N * (N * N + 1)> keys{};
+    std::uint64_t state = 0x9E3779B97F4A7C15ULL * N;
+
+    for (int cell = 0; cell < N * N; cell++)
+        for (int value = 1; value <= N * N; value++) {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            keys[cell * (N * N + 1) + value] = z ^ (z >> 31);
+        }
+
+    return keys;
+}();
+
+// Number of rotations and reflections of a square (dihedral group)
+const int SYMMETRIES = 8;
+
+// Row-major cell each cell is moved to by every rotation and reflection
+template<int N>
+inline constexpr auto SYMMETRY_CELLS = [] {
+    std::array<std::array<int, N * N>, SYMMETRIES> cells{};
+
+    for (int row = 0; row < N; row++)
+        for (int col = 0; col < N; col++) {
+            int r = N - 1 - row, c = N - 1 - col, cell = row * N + col;
+
+            cells[0][cell] = row * N + col;
+            cells[1][cell] = col * N + r;
+            cells[2][cell] = r * N + c;
+            cells[3][cell] = c * N + row;
+            cells[4][cell] = row * N + c;
+            cells[5][cell] = r * N + col;
+            cells[6][cell] = col * N + row;
+            cells[7][cell] = c * N + r;
+        }
+
+    return cells;
+}();
 
 // Define the mutation rate and the number of changes needed to increase the mutation rate
 const double BASE_MUTATION = 0.1;
 const double BASE_CHANGE_COUNT = 3;
 
+template<int N>
+class MagicSquare;
+
+template<int N>
+class Population;
+
+template<int N>
+bool operator==(const MagicSquare<N> &, const MagicSquare<N> &);
+
+template<int N>
+bool operator!=(const MagicSquare<N> &, const MagicSquare<N> &);
+
 /**
  * Base structure of a single magic square.
- * The size is is passed to constructor.
+ * The size is fixed at compile time by the template parameter.
+ * Cells are kept in one contiguous row-major buffer, the sums of all rows,
+ * columns and both diagonals are cached next to them and kept up to date
+ * on every change, so the fitness never has to be recomputed from scratch.
+ * A Zobrist hash of the cells is maintained the same way and lets unequal
+ * squares be told apart without comparing their cells.
  *
  */
+template<int N>
 class MagicSquare {
+    static_assert(N <= 255, "Cell values of larger squares don't fit into 16 bits");
+
 public:
-    explicit MagicSquare(int, bool = true);
+    static constexpr int SUM = magicSum(N);
+
+    // Number of cached line sums: rows, columns and both diagonals
+    static constexpr int LINES = 2 * N + 2;
+
+    // Upper bound of the fitness, a line is off by at most the magic sum or the spread of a permutation
+    static constexpr int MAX_FITNESS = LINES * std::max(SUM, N * N * (N - 1) / 2);
+
+    explicit MagicSquare(bool = true);
 
     void init();
 
@@ -32,55 +119,66 @@ public:
 
     void swap();
 
-    void print(bool = true);
+    [[nodiscard]] int evaluateSwapDelta(int fromRow, int fromCol, int toRow, int toCol) const;
 
-    void write(std::string &);
+    void applySwap(int fromRow, int fromCol, int toRow, int toCol);
 
-    int fitnessRows(int row_index = -1);
+    // Kernels working on raw row-major cells and line sums, shared with Population
+    static int evaluateLines(const Cell<N> *values, int *lines);
 
-    int fitnessColumns(int col_index = -1);
+    static int updateLines(int *lines, int row, int col, int delta);
 
-    int fitnessDiagonal1();
+    static int swapDelta(const Cell<N> *values, const int *lines, int fromRow, int fromCol, int toRow, int toCol);
 
-    int fitnessDiagonal2();
+    [[nodiscard]] static std::uint64_t zobrist(int cell, int value) { return ZOBRIST_KEYS<N>[cell * (N * N + 1) + value]; }
 
-    [[nodiscard]] auto getFitness() const { return this->fitness; }
+    static std::uint64_t hashCells(const Cell<N> *values);
+
+    static std::uint64_t canonicalHashCells(const Cell<N> *values);
+
+    static bool equivalentCells(const Cell<N> *a, const Cell<N> *b);
 
-    [[nodiscard]] auto getSum() const { return this->sum; }
+    void print(bool = true);
 
-    [[nodiscard]] auto getValue(int row, int col) const { return this->values[row][col]; }
+    void write(std::string &);
 
-    auto &getValues() { return this->values; }
+    [[nodiscard]] int fitnessRows(int row_index = -1) const;
 
-    void setValue(int row, int col, int value) { this->values[row][col] = value; }
+    [[nodiscard]] int fitnessColumns(int col_index = -1) const;
 
-    bool valueExist(int);
+    [[nodiscard]] int fitnessDiagonal1() const;
 
-    MagicSquare &operator=(const MagicSquare &);
+    [[nodiscard]] int fitnessDiagonal2() const;
 
-    friend bool operator==(const MagicSquare &, const MagicSquare &);
+    [[nodiscard]] auto getFitness() const { return this->fitness; }
 
-    friend bool operator!=(const MagicSquare &, const MagicSquare &);
+    [[nodiscard]] auto getHash() const { return this->hash; }
 
-private:
-    std::vector<std::vector<int>> values;
-    int dimension;
-    int fitness;
-    int sum;
-};
+    [[nodiscard]] std::uint64_t getCanonicalHash() const { return canonicalHashCells(this->values.data()); }
 
-bool operator==(const MagicSquare &, const MagicSquare &);
+    [[nodiscard]] bool equivalent(const MagicSquare &other) const { return equivalentCells(this->values.data(), other.values.data()); }
 
-bool operator!=(const MagicSquare &, const MagicSquare &);
+    [[nodiscard]] static constexpr auto getSum() { return SUM; }
 
-void sort(std::vector<MagicSquare> &);
+    [[nodiscard]] int getValue(int row, int col) const { return this->values[row * N + col]; }
 
-void selection(std::vector<MagicSquare> &, std::vector<MagicSquare> &);
+    [[nodiscard]] const auto &getValues() const { return this->values; }
 
-void crossover(std::vector<MagicSquare> &, std::vector<MagicSquare> &, int);
+    void setValue(int row, int col, int value);
 
-void mutate(std::vector<MagicSquare> &population, double probability);
+    bool valueExist(int);
+
+    friend bool operator==<N>(const MagicSquare &, const MagicSquare &);
+
+    friend bool operator!=<N>(const MagicSquare &, const MagicSquare &);
+
+    friend class Population<N>;
 
-MagicSquare solve(std::vector<MagicSquare> &, int, int, bool = false);
+private:
+    Genome<N> values;
+    std::array<int, LINES> lines;
+    int fitness;
+    std::uint64_t hash;
+};
 
 #endif //PERFECT_MAGIC_SQUARE_MAGIC_SQUARE_H
@@ -0,0 +1,321 @@
+#ifndef PERFECT_MAGIC_SQUARE_POPULATION_H
+#define PERFECT_MAGIC_SQUARE_POPULATION_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "magic_square.h"
+
+template<int N>
+class FitnessCache;
+
+/**
+ * Population of magic squares stored as structure of arrays.
+ * All genomes live in one contiguous block [individual][cell] of narrow cells,
+ * fitness, cached line sums and Zobrist hashes are kept in parallel arrays.
+ * Individuals are addressed by index, copying one between populations
+ * moves its cells, line sums and fitness without re-evaluating it.
+ * The genome block is padded so that vector loads of the last row stay in bounds.
+ *
+ */
+template<int N>
+class Population {
+public:
+    static constexpr int CELLS = N * N;
+    static constexpr int LINES = MagicSquare<N>::LINES;
+    static constexpr int PADDING = 16;
+
+    explicit Population(int = 0, bool = true);
+
+    [[nodiscard]] int size() const { return this->count; }
+
+    void clear() { this->resize(0); }
+
+    void resize(int);
+
+    void randomize(int);
+
+    void shuffle(int);
+
+    void evaluate() { this->evaluate(0, this->count); }
+
+    void evaluate(int);
+
+    void evaluate(int, int);
+
+    void evaluate(int, FitnessCache<N> &);
+
+    void evaluate(int, int, FitnessCache<N> &);
+
+    void swap(int);
+
+    void copy(int, const Population &, int);
+
+    void push_back(const Population &, int);
+
+    void push_back(const Genome<N> &);
+
+    void push_back(const MagicSquare<N> &);
+
+    [[nodiscard]] MagicSquare<N> get(int) const;
+
+    void set(int, const MagicSquare<N> &);
+
+    void set(int, const Genome<N> &);
+
+    [[nodiscard]] bool equal(int, const Population &, int) const;
+
+    [[nodiscard]] bool equivalent(int, const Population &, int) const;
+
+    [[nodiscard]] std::uint64_t hash(int index) const { return this->hashes[index]; }
+
+    [[nodiscard]] std::uint64_t canonicalHash(int index) const { return MagicSquare<N>::canonicalHashCells(this->genome(index)); }
+
+    [[nodiscard]] auto getFitness(int index) const { return this->fitness[index]; }
+
+    [[nodiscard]] int getValue(int index, int row, int col) const { return this->cells[index * CELLS + row * N + col]; }
+
+    [[nodiscard]] const Cell<N> *genome(int index) const { return this->cells.data() + index * CELLS; }
+
+    [[nodiscard]] const int *lineSums(int index) const { return this->lines.data() + index * LINES; }
+
+    [[nodiscard]] int fitnessRows(int index, int row) const { return std::abs(this->lineSums(index)[row] - MagicSquare<N>::SUM); }
+
+    [[nodiscard]] int fitnessColumns(int index, int col) const { return std::abs(this->lineSums(index)[N + col] - MagicSquare<N>::SUM); }
+
+    friend class FitnessCache<N>;
+
+private:
+    void evaluateVector(int);
+
+    int count;
+    std::vector<Cell<N>> cells;
+    std::vector<int> lines;
+    std::vector<int> fitness;
+    std::vector<std::uint64_t> hashes;
+};
+
+// Number of slots of the fitness cache
+const int FITNESS_CACHE_SIZE = 1 << 14;
+
+/**
+ * Fixed size cache of evaluations keyed by genome hash, shared by all threads.
+ * Slots are direct mapped and guarded by their own spin lock, a newer genome
+ * simply replaces the one in its slot. Hits and misses are counted.
+ *
+ */
+template<int N>
+class FitnessCache {
+public:
+    static constexpr int CELLS = N * N;
+    static constexpr int LINES = MagicSquare<N>::LINES;
+
+    explicit FitnessCache(int = FITNESS_CACHE_SIZE);
+
+    bool lookup(Population<N> &, int);
+
+    void store(const Population<N> &, int);
+
+    [[nodiscard]] long long getHits() const { return this->hits.load(); }
+
+    [[nodiscard]] long long getMisses() const { return this->misses.load(); }
+
+private:
+    std::size_t mask;
+    std::vector<std::uint64_t> keys;
+    std::vector<Cell<N>> cells;
+    std::vector<int> lines;
+    std::vector<int> fitness;
+    std::vector<std::atomic_flag> locks;
+    std::atomic<long long> hits;
+    std::atomic<long long> misses;
+};
+
+/**
+ * Set of genomes used to eliminate duplicates in O(1) per lookup.
+ * Entries refer to individuals of populations by index and are found by their
+ * Zobrist hash, cells are only compared when two hashes are equal.
+ * A symmetric set uses the canonical hash instead and treats rotations and
+ * reflections of a square as duplicates.
+ * The open addressing table is kept across clear() so reuse doesn't allocate.
+ *
+ */
+template<int N>
+class GenomeSet {
+public:
+    explicit GenomeSet(int = 0, bool = false);
+
+    void clear();
+
+    void reserve(int);
+
+    bool insert(const Population<N> &, int);
+
+    bool erase(const Population<N> &, int);
+
+    [[nodiscard]] bool contains(const Population<N> &, int) const;
+
+    [[nodiscard]] int size() const { return this->count; }
+
+private:
+    struct Entry {
+        std::uint64_t hash;
+        const Population<N> *population;
+        int index;
+    };
+
+    [[nodiscard]] std::uint64_t hash(const Population<N> &, int) const;
+
+    [[nodiscard]] std::size_t find(const Population<N> &, int, std::uint64_t) const;
+
+    std::vector<Entry> entries;
+    std::size_t mask;
+    int count;
+    bool symmetric;
+};
+
+// Number of squares remembered by the hall of fame
+const int HALL_OF_FAME_SIZE = 100;
+
+/**
+ * Bounded archive of the best distinct squares seen so far.
+ * Members are looked up by hash in O(1), a square only enters if it beats the worst member,
+ * which it then replaces. It is used to restart a stagnating search.
+ *
+ */
+template<int N>
+class HallOfFame {
+public:
+    explicit HallOfFame(int = HALL_OF_FAME_SIZE, bool = false);
+
+    bool offer(const Population<N> &, int);
+
+    [[nodiscard]] bool contains(const Population<N> &, int) const;
+
+    [[nodiscard]] const Population<N> &members() const { return this->archive; }
+
+    [[nodiscard]] int size() const { return this->archive.size(); }
+
+private:
+    int capacity;
+    int worst;
+    Population<N> archive;
+    GenomeSet<N> index;
+};
+
+/**
+ * Random squares generated ahead of time by a background thread.
+ * The producer shuffles, evaluates and hashes squares into a ring buffer,
+ * a single consumer copies them out, falling back to creating a square itself
+ * whenever the ring runs empty. Both sides only synchronise through two counters.
+ *
+ */
+template<int N>
+class ImmigrantPool {
+public:
+    explicit ImmigrantPool(int);
+
+    ~ImmigrantPool();
+
+    ImmigrantPool(const ImmigrantPool &) = delete;
+
+    ImmigrantPool &operator=(const ImmigrantPool &) = delete;
+
+    void take(Population<N> &, int);
+
+private:
+    void produce();
+
+    Population<N> ring;
+    std::atomic<long long> head;
+    std::atomic<long long> tail;
+    std::atomic<bool> stop;
+    std::thread producer;
+};
+
+// How crossover draws its parents from the population
+enum class Sampling {
+    UNIFORM,
+    ROULETTE,
+    RANK
+};
+
+// How a child is combined from its parents
+enum class Crossover {
+    FITTEST,
+    PMX,
+    OX,
+    CX
+};
+
+/**
+ * Walker's alias table drawing indices proportional to given weights in O(1).
+ * It is only read once built, so threads may share it, each with its own generator.
+ *
+ */
+class AliasTable {
+public:
+    void build(const std::vector<double> &);
+
+    [[nodiscard]] int sample(std::mt19937 &) const;
+
+    [[nodiscard]] int size() const { return static_cast<int>(this->alias.size()); }
+
+private:
+    std::vector<double> probability;
+    std::vector<int> alias;
+
+    // Work lists of the build, kept so rebuilding doesn't allocate
+    std::vector<int> small;
+    std::vector<int> large;
+};
+
+template<int N>
+void sort(const Population<N> &, std::vector<int> &, int = -1);
+
+template<int N>
+int best(const Population<N> &, int = 0, int = -1);
+
+template<int N>
+void tournament(const Population<N> &, std::vector<int> &, int);
+
+template<int N>
+void selection(const Population<N> &, std::vector<int> &, GenomeSet<N> &, int = 0);
+
+template<int N>
+void weigh(const Population<N> &, AliasTable &, Sampling);
+
+template<int N>
+void breed(const Population<N> &, int, int, std::mt19937 &, Genome<N> &);
+
+template<int N>
+void partiallyMapped(const Cell<N> *, const Cell<N> *, std::mt19937 &, Genome<N> &);
+
+template<int N>
+void orderCrossover(const Cell<N> *, const Cell<N> *, std::mt19937 &, Genome<N> &);
+
+template<int N>
+void cycleCrossover(const Cell<N> *, const Cell<N> *, std::mt19937 &, Genome<N> &);
+
+template<int N>
+void recombine(const Population<N> &, int, int, std::mt19937 &, Genome<N> &, Crossover);
+
+template<int N>
+int crossover(const Population<N> &, Population<N> &, int, const AliasTable &, Crossover = Crossover::FITTEST);
+
+template<int N>
+void mutate(Population<N> &, double, int = 0, int = -1);
+
+template<int N>
+MagicSquare<N> solve(Population<N> &, int, bool = false, bool = false, int = 0, Sampling = Sampling::UNIFORM, int = 0,
+                     Crossover = Crossover::FITTEST);
+
+template<int N>
+MagicSquare<N> steadyState(Population<N> &, int, bool = false, bool = false, int = 0,
+                           Crossover = Crossover::FITTEST);
+
+#endif //PERFECT_MAGIC_SQUARE_POPULATION_H
@@ -4,76 +4,201 @@
 
 #include "magic_square.h"
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <random>
 #include <iomanip>
 #include <fstream>
 
-#include <omp.h>
-
 #include "tabulate.hpp"
 
 /**
- * Create a new magic square with given size.
+ * Create a new magic square.
  *
- * @param size
  * @param randomize
  */
-MagicSquare::MagicSquare(int size, bool randomize) : dimension(size), fitness(0) {
-    this->values.resize(size, std::vector<int>(size));
-    this->sum = MAGIC_SUM(size);
-
+template<int N>
+MagicSquare<N>::MagicSquare(bool randomize) : values(), lines(), fitness(0), hash(0) {
     if (randomize) this->randomize();
-
-    this->evaluate();
+    else this->evaluate();
 }
 
 /**
  * Init square with 0 values.
  */
-void MagicSquare::init() {
-    std::fill(this->values.begin(), this->values.end(), std::vector<int>(this->dimension, 0));
+template<int N>
+void MagicSquare<N>::init() {
+    std::fill(this->values.begin(), this->values.end(), 0);
     this->evaluate();
 }
 
 /**
  * Generate random numbers for magic square.
  */
-void MagicSquare::randomize() {
+template<int N>
+void MagicSquare<N>::randomize() {
     thread_local std::mt19937 rng(std::random_device{}());
-    std::vector<int> numbers(this->dimension * this->dimension);
-    std::iota(numbers.begin(), numbers.end(), 1); // Fill numbers from 1 to n*n
-    std::shuffle(numbers.begin(), numbers.end(), rng); // Shuffle numbers
 
-    // Fill the square with shuffled numbers
-    for (int i = 0; i < this->dimension; ++i)
-        for (int j = 0; j < this->dimension; ++j)
-            this->values[i][j] = numbers[i * this->dimension + j];
+    // Fill the square with numbers from 1 to n*n and shuffle them in place
+    std::iota(this->values.begin(), this->values.end(), 1);
+    std::shuffle(this->values.begin(), this->values.end(), rng);
 
     evaluate(); // Evaluate the new configuration
 }
 
 /**
  * Evaluate the fitness of a square solution.
+ * Recomputes all cached line sums and the hash from the cells.
+ *
+ */
+template<int N>
+void MagicSquare<N>::evaluate() {
+    this->fitness = evaluateLines(this->values.data(), this->lines.data());
+    this->hash = hashCells(this->values.data());
+}
+
+/**
+ * Calculate all line sums of a row-major square and return its fitness.
+ *
+ * @param values
+ * @param lines
+ * @return
+ */
+template<int N>
+int MagicSquare<N>::evaluateLines(const Cell<N> *values, int *lines) {
+    std::fill(lines, lines + LINES, 0);
+
+    for (int row = 0; row < N; row++)
+        for (int col = 0; col < N; col++) {
+            int value = values[row * N + col];
+
+            lines[row] += value;
+            lines[N + col] += value;
+        }
+
+    for (int i = 0; i < N; i++) {
+        lines[2 * N] += values[i * N + i];
+        lines[2 * N + 1] += values[(N - (i + 1)) * N + i];
+    }
+
+    int fit = 0;
+
+    for (int line = 0; line < LINES; line++)
+        fit += std::abs(lines[line] - SUM);
+
+    return fit;
+}
+
+/**
+ * Calculate the Zobrist hash of row-major cells.
+ *
+ * @param values
+ * @return
+ */
+template<int N>
+std::uint64_t MagicSquare<N>::hashCells(const Cell<N> *values) {
+    std::uint64_t h = 0;
+
+    for (int i = 0; i < N * N; i++)
+        h ^= zobrist(i, values[i]);
+
+    return h;
+}
+
+/**
+ * Calculate a hash shared by all rotations and reflections of row-major cells.
+ * The Zobrist hash of every symmetric square is gathered in one pass, the smallest one is kept.
  *
+ * @param values
+ * @return
  */
-void MagicSquare::evaluate() {
-    this->fitness = 0;
+template<int N>
+std::uint64_t MagicSquare<N>::canonicalHashCells(const Cell<N> *values) {
+    std::array<std::uint64_t, SYMMETRIES> h{};
+
+    for (int i = 0; i < N * N; i++)
+        for (int s = 0; s < SYMMETRIES; s++)
+            h[s] ^= zobrist(SYMMETRY_CELLS<N>[s][i], values[i]);
 
-    this->fitness += this->fitnessRows();
-    this->fitness += this->fitnessColumns();
-    this->fitness += this->fitnessDiagonal1();
-    this->fitness += this->fitnessDiagonal2();
+    return *std::min_element(h.begin(), h.end());
+}
+
+/**
+ * Check if row-major cells are equal to a rotation or reflection of other cells.
+ *
+ * @param a
+ * @param b
+ * @return
+ */
+template<int N>
+bool MagicSquare<N>::equivalentCells(const Cell<N> *a, const Cell<N> *b) {
+    for (const auto &cells: SYMMETRY_CELLS<N>) {
+        int i = 0;
+
+        while (i < N * N && a[cells[i]] == b[i]) i++;
+
+        if (i == N * N)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Add delta to every line through a cell and return the resulting change of fitness.
+ *
+ * @param lines
+ * @param row
+ * @param col
+ * @param delta
+ * @return
+ */
+template<int N>
+int MagicSquare<N>::updateLines(int *lines, int row, int col, int delta) {
+    int change = 0;
+
+    auto shift = [lines, delta, &change](int line) {
+        change -= std::abs(lines[line] - SUM);
+        lines[line] += delta;
+        change += std::abs(lines[line] - SUM);
+    };
+
+    shift(row);
+    shift(N + col);
+
+    if (row == col) shift(2 * N);
+    if (row + col == N - 1) shift(2 * N + 1);
+
+    return change;
+}
+
+/**
+ * Set value of a single cell, keeping line sums, fitness and hash up to date.
+ *
+ * @param row
+ * @param col
+ * @param value
+ */
+template<int N>
+void MagicSquare<N>::setValue(int row, int col, int value) {
+    int cell = row * N + col;
+
+    this->fitness += updateLines(this->lines.data(), row, col, value - this->values[cell]);
+    this->hash ^= zobrist(cell, this->values[cell]) ^ zobrist(cell, value);
+    this->values[cell] = value;
 }
 
 /**
  * Change position of two random numbers.
+ * Only the lines through both cells are updated.
  *
  */
-void MagicSquare::swap() {
+template<int N>
+void MagicSquare<N>::swap() {
     int fromRow, toRow, fromCol, toCol;
     thread_local std::mt19937 rng(std::random_device{}());
-    thread_local std::uniform_int_distribution<int> dist(0, this->dimension - 1);
+    thread_local std::uniform_int_distribution<int> dist(0, N - 1);
 
     do {
         fromRow = dist(rng);
@@ -82,8 +207,86 @@ void MagicSquare::swap() {
         toCol = dist(rng);
     } while ((fromRow == toRow) && (fromCol == toCol));
 
-    std::swap(this->values[fromRow][fromCol], this->values[toRow][toCol]);
-    this->evaluate();
+    this->applySwap(fromRow, fromCol, toRow, toCol);
+}
+
+/**
+ * Calculate the change of fitness swapping two cells would cause,
+ * using the cached line sums only. The square itself is not modified.
+ *
+ * @param fromRow
+ * @param fromCol
+ * @param toRow
+ * @param toCol
+ * @return
+ */
+template<int N>
+int MagicSquare<N>::evaluateSwapDelta(int fromRow, int fromCol, int toRow, int toCol) const {
+    return swapDelta(this->values.data(), this->lines.data(), fromRow, fromCol, toRow, toCol);
+}
+
+/**
+ * Calculate the change of fitness of a swap on raw cells and line sums.
+ *
+ * @param values
+ * @param lines
+ * @param fromRow
+ * @param fromCol
+ * @param toRow
+ * @param toCol
+ * @return
+ */
+template<int N>
+int MagicSquare<N>::swapDelta(const Cell<N> *values, const int *lines, int fromRow, int fromCol, int toRow, int toCol) {
+    int delta = values[toRow * N + toCol] - values[fromRow * N + fromCol];
+    int affected[8], shift[8], count = 0;
+
+    // Collect the lines through both cells, lines shared by both cancel out
+    auto add = [&](int line, int d) {
+        for (int i = 0; i < count; i++)
+            if (affected[i] == line) {
+                shift[i] += d;
+                return;
+            }
+
+        affected[count] = line;
+        shift[count++] = d;
+    };
+
+    auto addCell = [&](int row, int col, int d) {
+        add(row, d);
+        add(N + col, d);
+
+        if (row == col) add(2 * N, d);
+        if (row + col == N - 1) add(2 * N + 1, d);
+    };
+
+    addCell(fromRow, fromCol, delta);
+    addCell(toRow, toCol, -delta);
+
+    int change = 0;
+
+    for (int i = 0; i < count; i++)
+        change += std::abs(lines[affected[i]] + shift[i] - SUM) - std::abs(lines[affected[i]] - SUM);
+
+    return change;
+}
+
+/**
+ * Swap two cells, keeping line sums, fitness and hash up to date.
+ *
+ * @param fromRow
+ * @param fromCol
+ * @param toRow
+ * @param toCol
+ */
+template<int N>
+void MagicSquare<N>::applySwap(int fromRow, int fromCol, int toRow, int toCol) {
+    int from = this->values[fromRow * N + fromCol];
+    int to = this->values[toRow * N + toCol];
+
+    this->setValue(fromRow, fromCol, to);
+    this->setValue(toRow, toCol, from);
 }
 
 /**
@@ -91,7 +294,8 @@ void MagicSquare::swap() {
  *
  * @param details
  */
-void MagicSquare::print(bool details) {
+template<int N>
+void MagicSquare<N>::print(bool details) {
     tabulate::Table square_table;
 
     // Initial table formatting for better readability
@@ -101,26 +305,26 @@ void MagicSquare::print(bool details) {
             .column_separator("");
 
     // Adding rows
-    for (auto &value: this->values) {
+    for (int i = 0; i < N; ++i) {
         tabulate::Table::Row_t table_row;
-        for (int j: value) table_row.push_back(std::to_string(j));
+        for (int j = 0; j < N; ++j) table_row.push_back(std::to_string(this->getValue(i, j)));
         square_table.add_row(table_row);
     }
 
     if (details) {
         // Apply initial color formatting after all rows have been added
-        for (size_t i = 0; i < this->values.size(); ++i)
-            for (size_t j = 0; j < this->values[i].size(); ++j)
+        for (int i = 0; i < N; ++i)
+            for (int j = 0; j < N; ++j)
                 square_table[i][j].format()
                         .font_background_color(tabulate::Color::green)
                         .font_color(tabulate::Color::grey);
 
         // Check and color rows and columns based on their fitness
-        for (int i = 0; i < this->values.size(); ++i) {
+        for (int i = 0; i < N; ++i) {
             int row_fitness = fitnessRows(i);
             int col_fitness = fitnessColumns(i);
 
-            for (int j = 0; j < this->values[i].size(); ++j)
+            for (int j = 0; j < N; ++j)
                 if (row_fitness != 0 || col_fitness != 0)
                     square_table[i][j].format()
                             .font_background_color(tabulate::Color::red);
@@ -128,14 +332,14 @@ void MagicSquare::print(bool details) {
 
         // Coloring diagonals if their fitness is not zero
         if (fitnessDiagonal1() == 0) {
-            for (int i = 0; i < this->values.size(); ++i)
+            for (int i = 0; i < N; ++i)
                 square_table[i][i].format()
                         .font_background_color(tabulate::Color::green);
         }
 
         if (fitnessDiagonal2() == 0) {
-            for (int i = 0; i < this->values.size(); ++i)
-                square_table[i][this->values.size() - 1 - i].format()
+            for (int i = 0; i < N; ++i)
+                square_table[i][N - 1 - i].format()
                         .font_background_color(tabulate::Color::green);
         }
 
@@ -150,12 +354,13 @@ void MagicSquare::print(bool details) {
  *
  * @param name
  */
-void MagicSquare::write(std::string &name) {
+template<int N>
+void MagicSquare<N>::write(std::string &name) {
     std::ofstream outputFile(name, std::ios::trunc);
 
-    for (const auto &row: this->values) {
-        for (const auto &num: row)
-            outputFile << num << ';';
+    for (int row = 0; row < N; row++) {
+        for (int col = 0; col < N; col++)
+            outputFile << this->getValue(row, col) << ';';
 
         outputFile << std::endl;
     }
@@ -164,57 +369,35 @@ void MagicSquare::write(std::string &name) {
 }
 
 /**
- * Calculate fitness for all rows of a square.
+ * Calculate fitness for all rows of a square or a single one.
  *
  * @return
  */
-int MagicSquare::fitnessRows(int row_index) {
-    int fit = 0;
-    int row = 0;
-    bool one_row = false;
-
-    for (auto &rows: this->values) {
-        int i = 0;
-
-        if (row_index != -1 && row != row_index) {
-            row++;
-            one_row = true;
-            continue;
-        }
+template<int N>
+int MagicSquare<N>::fitnessRows(int row_index) const {
+    if (row_index != -1) return std::abs(this->lines[row_index] - SUM);
 
-        for (auto cols: rows) i += cols;
-
-        if (one_row) return std::abs(i - this->sum);
+    int fit = 0;
 
-        fit += std::abs(i - this->sum);
-    }
+    for (int row = 0; row < N; row++)
+        fit += std::abs(this->lines[row] - SUM);
 
     return fit;
 }
 
 /**
- * Calculate fitness for all columns of a square.
+ * Calculate fitness for all columns of a square or a single one.
  *
  * @return
  */
-int MagicSquare::fitnessColumns(int col_index) {
-    int fit = 0;
-
-    for (int cols = 0; cols < this->dimension; cols++) {
-        int i = 0;
-
-        if (col_index != -1) {
-            for (auto &value: this->values)
-                i += value[col_index];
-
-            return std::abs(i - this->sum);
-        }
+template<int N>
+int MagicSquare<N>::fitnessColumns(int col_index) const {
+    if (col_index != -1) return std::abs(this->lines[N + col_index] - SUM);
 
-        for (auto &value: this->values)
-            i += value[cols];
+    int fit = 0;
 
-        fit += std::abs(i - this->sum);
-    }
+    for (int col = 0; col < N; col++)
+        fit += std::abs(this->lines[N + col] - SUM);
 
     return fit;
 }
@@ -224,13 +407,9 @@ int MagicSquare::fitnessColumns(int col_index) {
  *
  * @return
  */
-int MagicSquare::fitnessDiagonal1() {
-    int s = 0;
-
-    for (int i = 0; i < this->dimension; i++)
-        s += this->values[i][i];
-
-    return std::abs(s - this->sum);
+template<int N>
+int MagicSquare<N>::fitnessDiagonal1() const {
+    return std::abs(this->lines[2 * N] - SUM);
 }
 
 /**
@@ -238,13 +417,9 @@ int MagicSquare::fitnessDiagonal1() {
  *
  * @return
  */
-int MagicSquare::fitnessDiagonal2() {
-    int s = 0;
-
-    for (int i = this->dimension - 1; i >= 0; i--)
-        s += this->values[this->dimension - (i + 1)][i];
-
-    return std::abs(s - this->sum);
+template<int N>
+int MagicSquare<N>::fitnessDiagonal2() const {
+    return std::abs(this->lines[2 * N + 1] - SUM);
 }
 
 /**
@@ -253,49 +428,28 @@ int MagicSquare::fitnessDiagonal2() {
  * @param value
  * @return
  */
-bool MagicSquare::valueExist(int value) {
-    for (auto &row: this->values)
-        for (auto col: row)
-            if (col == value)
-                return true;
-
-    return false;
-}
-
-/**
- * Copy assign magic square.
- *
- * @param other
- * @return
- */
-MagicSquare &MagicSquare::operator=(const MagicSquare &other) {
-    if (this != &other)
-        for (int row = 0; row < this->dimension; row++)
-            for (int col = 0; col < this->dimension; col++)
-                this->values[row][col] = other.getValue(row, col);
-
-    this->evaluate();
-
-    return *this;
+template<int N>
+bool MagicSquare<N>::valueExist(int value) {
+    return std::find(this->values.begin(), this->values.end(), value) != this->values.end();
 }
 
 /**
  * Custom operator comparing squares.
+ * Squares with different hashes are rejected without comparing their cells.
  *
  * @param a
  * @param b
  * @return
  */
-bool operator==(const MagicSquare &a, const MagicSquare &b) {
+template<int N>
+bool operator==(const MagicSquare<N> &a, const MagicSquare<N> &b) {
     if (&a == &b)
         return true;
 
-    for (int row = 0; row < a.dimension; row++)
-        for (int col = 0; col < a.dimension; col++)
-            if (a.getValue(row, col) != b.getValue(row, col))
-                return false;
+    if (a.hash != b.hash)
+        return false;
 
-    return true;
+    return a.values == b.values;
 }
 
 /**
@@ -305,209 +459,21 @@ bool operator==(const MagicSquare &a, const MagicSquare &b) {
  * @param b
  * @return
  */
-bool operator!=(const MagicSquare &a, const MagicSquare &b) {
+template<int N>
+bool operator!=(const MagicSquare<N> &a, const MagicSquare<N> &b) {
     return !(a == b);
 }
 
-/**
- * Sort squares by fitness.
- *
- * @param population
- */
-void sort(std::vector<MagicSquare> &population) {
-    std::sort(population.begin(),
-              population.end(), [](const MagicSquare &a, const MagicSquare &b) {
-                return a.getFitness() < b.getFitness();
-            });
-}
-
-/**
- * Select the best third of the population.
- *
- * @param population
- * @param selected
- * @return
- */
-void selection(std::vector<MagicSquare> &population, std::vector<MagicSquare> &selected) {
-    sort(population);
-
-    std::vector<MagicSquare> local_selected;
-
-    for (int i = 0; i < population.size() / 3; i++)
-        if (std::find(selected.begin(), selected.end(), population[i]) == selected.end())
-            local_selected.push_back(population[i]);
-
-    // Merge local vectors into the global vector
-    selected.insert(selected.end(), local_selected.begin(), local_selected.end());
-}
-
-/**
- * Combine random squares from population.
- *
- * @param offspring
- * @param size
- * @param population
- * @return
- */
-void crossover(std::vector<MagicSquare> &population, std::vector<MagicSquare> &offspring, int size) {
-#pragma omp parallel default(none) shared(population, offspring, size)
-    {
-        thread_local std::mt19937 rng1(std::random_device{}());
-        thread_local std::mt19937 rng2(std::random_device{}());
-        thread_local std::mt19937 rng3(std::random_device{}());
-        thread_local std::uniform_int_distribution<int> distParent(0, population.size() - 1);
-        thread_local std::uniform_int_distribution<int> distFill(1, size * size);
-        std::vector<MagicSquare> localOffspring;  // Local storage for each thread's offspring
-
-#pragma omp for nowait  // Distribute loop iterations across threads without waiting
-        for (int i = 0; i < population.size() / 3; i++) {
-            MagicSquare child(size, false);
-
-            child.init();
-
-            MagicSquare parent1 = population[distParent(rng1)];
-            MagicSquare parent2 = population[distParent(rng2)];
-
-            while (parent1 == parent2) parent2 = population[distParent(rng2)];
-
-            // Select values based on fitness
-            for (int row = 0; row < size; ++row) {
-                for (int col = 0; col < size; ++col) {
-                    int val1 = parent1.getValue(row, col);
-                    int val2 = parent2.getValue(row, col);
-                    int chosenValue = ((parent1.fitnessRows(row) + parent1.fitnessColumns(col)) <
-                            (parent2.fitnessRows(row) + parent2.fitnessColumns(col))) ? val1 : val2;
-                    if (!child.valueExist(chosenValue)) {
-                        child.setValue(row, col, chosenValue);
-                    }
-                }
-            }
-
-            // Fill the rest with random values
-            for (int row = 0; row < size; ++row) {
-                for (int col = 0; col < size; ++col) {
-                    if (child.getValue(row, col) == 0) {
-                        int newValue;
-                        do {
-                            newValue = distFill(rng3);
-                        } while (child.valueExist(newValue));
-                        child.setValue(row, col, newValue);
-                    }
-                }
-            }
-
-            child.evaluate();
-            localOffspring.push_back(child);
-        }
-
-#pragma omp critical  // Use critical section to safely merge results from each thread
-        {
-            offspring.insert(offspring.end(), localOffspring.begin(), localOffspring.end());
-        }
-    }
-}
-
-
-/**
- * Change position of two numbers in a square by a given probability.
- *
- * @param population
- * @param probability
- */
-void mutate(std::vector<MagicSquare> &population, double probability) {
-#pragma omp parallel default(none) shared(population, probability)
-    {
-        thread_local std::mt19937 rng(std::random_device{}());
-        thread_local std::uniform_real_distribution<double> dist(0.0, 1.0);
-        // Mutate each square with a certain probability
-#pragma omp for nowait
-        for (auto &square: population)
-            if (dist(rng) < probability)
-                square.swap();
-    }
-}
-
-/**
- * Solve a magic square using given parameters.
- *
- * @param population
- * @param size
- * @param iterations
- * @param verbose
- * @return
- */
-MagicSquare solve(std::vector<MagicSquare> &population, int size, int iterations, bool verbose) {
-    int lastFitness = -1;
-    int unchanged = 0;
-    double probability = BASE_MUTATION;
-    bool infinite = false;
-
-    if (iterations == -1) infinite = true;
-
-    for (int it = 0; (it < iterations) || infinite; it++) {
-        auto selected = std::vector<MagicSquare>();
-        auto offspring = std::vector<MagicSquare>();
-        auto check = std::vector<MagicSquare>();
-        selection(population, selected);
-
-        if (selected.front().getFitness() == 0)
-            return selected.front();
-
-        if (verbose) {
-            int count = 5;
-
-            std::cout << "Current top 5:" << std::endl << std::endl;
-
-            while (count > 0) {
-                std::cout << '#' << count << ':' << std::endl;
-                selected[count - 1].print();
-                count--;
-            }
-        }
-
-        crossover(population, offspring, size);
-        sort(offspring);
-
-        if (offspring.front().getFitness() == 0)
-            return offspring.front();
-
-        if (population.front().getFitness() == lastFitness) {
-            unchanged++;
-
-            if (probability < 1 && unchanged >= BASE_CHANGE_COUNT) probability += 0.1;
-        } else {
-            unchanged = 0;
-            probability = BASE_MUTATION;
-        }
-
-        mutate(offspring, probability);
-
-        int i = 0;
-        for (auto &oneSquare: selected) {
-            population[i] = oneSquare;
-            i++;
-        }
-
-        for (auto &oneSquare: offspring) {
-            if (std::find(selected.begin(), selected.end(), oneSquare) == selected.end()) {
-                population[i] = oneSquare;
-                i++;
-            }
-        }
-
-        while (i < population.size()) {
-            MagicSquare tmpSquare = MagicSquare(size);
-
-            if ((std::find(selected.begin(), selected.end(), tmpSquare) == selected.end()) &&
-                (std::find(offspring.begin(), offspring.end(), tmpSquare) == offspring.end()) &&
-                (std::find(check.begin(), check.end(), tmpSquare) == check.end())) {
-                population[i] = tmpSquare;
-                check.push_back(tmpSquare);
-                i++;
-            }
-        }
-    }
-
-    sort(population);
-    return population.front();
-}
+// Explicit instantiations for all supported square dimensions
+#define INSTANTIATE_MAGIC_SQUARE(N) \
+    template class MagicSquare<N>; \
+    template bool operator==(const MagicSquare<N> &, const MagicSquare<N> &); \
+    template bool operator!=(const MagicSquare<N> &, const MagicSquare<N> &);
+
+INSTANTIATE_MAGIC_SQUARE(3)
+INSTANTIATE_MAGIC_SQUARE(4)
+INSTANTIATE_MAGIC_SQUARE(5)
+INSTANTIATE_MAGIC_SQUARE(6)
+INSTANTIATE_MAGIC_SQUARE(7)
+INSTANTIATE_MAGIC_SQUARE(8)
+INSTANTIATE_MAGIC_SQUARE(9)
@@ -2,13 +2,56 @@
 // Created by Adnan Vatric on 17.02.23.
 //
 
-#include "magic_square.h"
+#include "population.h"
 
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 
 #include "program_options.h"
 
+/**
+ * Run the solver for a square dimension known at compile time.
+ *
+ * @param populationSize
+ * @param iterations
+ * @param verbose
+ * @param silent
+ * @param symmetric
+ * @param tournamentSize
+ * @param sampling
+ * @param steady
+ * @param restart
+ * @param method
+ * @param name
+ * @return
+ */
+template<int N>
+int run(int populationSize, int iterations, bool verbose, bool silent, bool symmetric, int tournamentSize,
+        Sampling sampling, bool steady, int restart, Crossover method, std::string &name) {
+    Population<N> population(populationSize);
+
+    auto square = steady ? steadyState(population, iterations, verbose, symmetric, tournamentSize, method)
+                         : solve(population, iterations, verbose, symmetric, tournamentSize, sampling, restart, method);
+
+    if (square.getFitness() == 0) {
+        if (!silent) {
+            std::cout << "Found solution:" << std::endl;
+            square.print(false);
+        }
+
+        if (!name.empty())
+            square.write(name.append(".csv"));
+
+        return EXIT_SUCCESS;
+    }
+
+    if (!silent)
+        std::cout << "No solution found!" << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
 /**
  * Entry point
  *
@@ -23,10 +66,20 @@ int main(int argc, char **argv) {
     bool verbose = program_options::has(args, "-v");
     bool help = program_options::has(args, "-h");
     bool silent = program_options::has(args, "-s");
+    bool symmetric = program_options::has(args, "-c");
 
     int size = 0;
     int populationSize = 0;
     int iterations = 0;
+    int tournamentSize = 0;
+    bool wrongSelection = false;
+    int restart = 0;
+    Sampling sampling = Sampling::UNIFORM;
+    bool wrongSampling = false;
+    Crossover method = Crossover::FITTEST;
+    bool wrongCrossover = false;
+    bool steady = false;
+    bool wrongEngine = false;
 
     std::string name;
 
@@ -47,12 +100,52 @@ int main(int argc, char **argv) {
     if (program_options::has(args, "-o"))
         name = program_options::get(args, "-o").begin();
 
+    if (program_options::has(args, "-r"))
+        restart = std::stoi(program_options::get(args, "-r").begin());
+
+    if (program_options::has(args, "-sel")) {
+        std::string_view mode = program_options::get(args, "-sel");
+
+        if (mode.starts_with("tournament:"))
+            tournamentSize = std::atoi(mode.substr(11).begin());
+        else if (mode != "truncation")
+            wrongSelection = true;
+
+        // Tournaments need at least two contestants
+        if (mode.starts_with("tournament:") && tournamentSize < 2)
+            wrongSelection = true;
+    }
+
+    if (program_options::has(args, "-par")) {
+        std::string_view mode = program_options::get(args, "-par");
+
+        if (mode == "roulette") sampling = Sampling::ROULETTE;
+        else if (mode == "rank") sampling = Sampling::RANK;
+        else if (mode != "uniform") wrongSampling = true;
+    }
+
+    if (program_options::has(args, "-x")) {
+        std::string_view mode = program_options::get(args, "-x");
+
+        if (mode == "pmx") method = Crossover::PMX;
+        else if (mode == "ox") method = Crossover::OX;
+        else if (mode == "cx") method = Crossover::CX;
+        else if (mode != "fittest") wrongCrossover = true;
+    }
+
+    if (program_options::has(args, "-e")) {
+        std::string_view engine = program_options::get(args, "-e");
+
+        if (engine == "steady") steady = true;
+        else if (engine != "generational") wrongEngine = true;
+    }
+
     if (silent && verbose) {
         std::cout << "Can't combine verbose and silent mode!" << std::endl << std::endl;
         fail = true;
     }
 
-    if (size < 3 || size > 9) {
+    if (size < MIN_DIMENSION || size > MAX_DIMENSION) {
         std::cout << "Wrong square dimension!" << std::endl << std::endl;
         fail = true;
     }
@@ -67,31 +160,62 @@ int main(int argc, char **argv) {
         fail = true;
     }
 
-    if (fail) {
-        program_options::description();
-        return EXIT_FAILURE;
+    if (wrongSelection && !fail) {
+        std::cout << "Wrong selection mode!" << std::endl << std::endl;
+        fail = true;
     }
 
-    std::vector<MagicSquare> population;
+    if (wrongSampling && !fail) {
+        std::cout << "Wrong parent sampling!" << std::endl << std::endl;
+        fail = true;
+    }
 
-    for (int i = 0; i < populationSize; i++) population.emplace_back(size);
+    if (wrongCrossover && !fail) {
+        std::cout << "Wrong crossover operator!" << std::endl << std::endl;
+        fail = true;
+    }
 
-    auto square = solve(population, size, iterations, verbose);
+    if (restart < 0 && !fail) {
+        std::cout << "Wrong restart count!" << std::endl << std::endl;
+        fail = true;
+    }
 
-    if (square.getFitness() == 0) {
-        if (!silent) {
-            std::cout << "Found solution:" << std::endl;
-            square.print(false);
-        }
+    if (wrongEngine && !fail) {
+        std::cout << "Wrong engine!" << std::endl << std::endl;
+        fail = true;
+    }
 
-        if (!name.empty())
-            square.write(name.append(".csv"));
+    // The steady-state engine draws parents uniformly or by tournament and never restarts
+    if (steady && program_options::has(args, "-par") && !fail) {
+        std::cout << "Can't combine parent sampling and steady engine!" << std::endl << std::endl;
+        fail = true;
+    }
 
-        return EXIT_SUCCESS;
+    if (steady && program_options::has(args, "-r") && !fail) {
+        std::cout << "Can't combine restarts and steady engine!" << std::endl << std::endl;
+        fail = true;
     }
 
-    if (!silent)
-        std::cout << "No solution found!" << std::endl;
+    if (fail) {
+        program_options::description();
+        return EXIT_FAILURE;
+    }
 
-    return EXIT_SUCCESS;
+    // Dispatch to the instantiation matching the requested dimension
+    switch (size) {
+        case 3:
+            return run<3>(populationSize, iterations, verbose, silent, symmetric, tournamentSize, sampling, steady, restart, method, name);
+        case 4:
+            return run<4>(populationSize, iterations, verbose, silent, symmetric, tournamentSize, sampling, steady, restart, method, name);
+        case 5:
+            return run<5>(populationSize, iterations, verbose, silent, symmetric, tournamentSize, sampling, steady, restart, method, name);
+        case 6:
+            return run<6>(populationSize, iterations, verbose, silent, symmetric, tournamentSize, sampling, steady, restart, method, name);
+        case 7:
+            return run<7>(populationSize, iterations, verbose, silent, symmetric, tournamentSize, sampling, steady, restart, method, name);
+        case 8:
+            return run<8>(populationSize, iterations, verbose, silent, symmetric, tournamentSize, sampling, steady, restart, method, name);
+        default:
+            return run<9>(populationSize, iterations, verbose, silent, symmetric, tournamentSize, sampling, steady, restart, method, name);
+    }
 }
@@ -0,0 +1,1620 @@
+#include "population.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include <omp.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Create a population of given size.
+ *
+ * @param size
+ * @param randomize
+ */
+template<int N>
+Population<N>::Population(int size, bool randomize) : count(0), cells(PADDING, 0) {
+    this->resize(size);
+
+    if (randomize) {
+        for (int i = 0; i < size; i++)
+            this->shuffle(i);
+
+        this->evaluate();
+    }
+}
+
+/**
+ * Change the number of individuals, new individuals are filled with 0 values.
+ *
+ * @param size
+ */
+template<int N>
+void Population<N>::resize(int size) {
+    int previous = this->count;
+
+    // Keep the padding behind the last genome zeroed when growing
+    std::fill_n(this->cells.data() + previous * CELLS, PADDING, 0);
+
+    this->cells.resize(size * CELLS + PADDING, 0);
+    this->lines.resize(size * LINES, 0);
+    this->fitness.resize(size, 0);
+    this->hashes.resize(size, 0);
+    this->count = size;
+
+    if (size > previous)
+        this->evaluate(previous, size);
+}
+
+/**
+ * Generate random numbers for a single individual.
+ *
+ * @param index
+ */
+template<int N>
+void Population<N>::randomize(int index) {
+    this->shuffle(index);
+    this->evaluate(index);
+}
+
+/**
+ * Fill a single individual with a random permutation of 1..N*N.
+ * The hash is updated, line sums and fitness are left stale until the next evaluation.
+ *
+ * @param index
+ */
+template<int N>
+void Population<N>::shuffle(int index) {
+    thread_local std::mt19937 rng(std::random_device{}());
+    Cell<N> *values = this->cells.data() + index * CELLS;
+
+    std::iota(values, values + CELLS, 1);
+    std::shuffle(values, values + CELLS, rng);
+    this->hashes[index] = MagicSquare<N>::hashCells(values);
+}
+
+/**
+ * Recompute line sums and fitness of a single individual.
+ *
+ * @param index
+ */
+template<int N>
+void Population<N>::evaluate(int index) {
+    this->fitness[index] = MagicSquare<N>::evaluateLines(this->cells.data() + index * CELLS,
+                                                         this->lines.data() + index * LINES);
+}
+
+/**
+ * Recompute line sums and fitness of a single individual with the vector kernel.
+ * With SSE2 and byte sized cells each row is summed with a single SAD and the
+ * columns are accumulated as 16 bit lanes, otherwise the scalar kernel is used.
+ *
+ * @param index
+ */
+template<int N>
+void Population<N>::evaluateVector(int index) {
+#if defined(__SSE2__)
+    if constexpr (sizeof(Cell<N>) == 1 && N <= PADDING) {
+        alignas(16) static constexpr auto rowMask = [] {
+            std::array<std::uint8_t, 16> mask{};
+
+            for (int i = 0; i < N; i++) mask[i] = 0xFF;
+
+            return mask;
+        }();
+
+        const Cell<N> *values = this->cells.data() + index * CELLS;
+        int *sums = this->lines.data() + index * LINES;
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i *>(rowMask.data()));
+        __m128i columnsLow = zero;
+        __m128i columnsHigh = zero;
+        alignas(16) std::uint16_t columns[16];
+
+        for (int row = 0; row < N; row++) {
+            // Loads past the row are masked out, the padding keeps the last row in bounds
+            __m128i cells = _mm_and_si128(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + row * N)), mask);
+            __m128i rowSum = _mm_sad_epu8(cells, zero);
+
+            sums[row] = _mm_cvtsi128_si32(rowSum) + _mm_extract_epi16(rowSum, 4);
+            columnsLow = _mm_add_epi16(columnsLow, _mm_unpacklo_epi8(cells, zero));
+            columnsHigh = _mm_add_epi16(columnsHigh, _mm_unpackhi_epi8(cells, zero));
+        }
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(columns), columnsLow);
+        _mm_store_si128(reinterpret_cast<__m128i *>(columns + 8), columnsHigh);
+
+        sums[2 * N] = 0;
+        sums[2 * N + 1] = 0;
+
+        for (int col = 0; col < N; col++) {
+            sums[N + col] = columns[col];
+            sums[2 * N] += values[col * N + col];
+            sums[2 * N + 1] += values[(N - (col + 1)) * N + col];
+        }
+
+        int fit = 0;
+
+        for (int line = 0; line < LINES; line++)
+            fit += std::abs(sums[line] - MagicSquare<N>::SUM);
+
+        this->fitness[index] = fit;
+
+        return;
+    }
+#endif
+
+    this->evaluate(index);
+}
+
+/**
+ * Recompute line sums and fitness of the individuals in [first, last) in one pass.
+ *
+ * @param first
+ * @param last
+ */
+template<int N>
+void Population<N>::evaluate(int first, int last) {
+#pragma omp parallel for default(none) shared(first, last)
+    for (int i = first; i < last; i++)
+        this->evaluateVector(i);
+}
+
+/**
+ * Take line sums and fitness of a single individual from the cache, evaluating and storing it on a miss.
+ *
+ * @param index
+ * @param cache
+ */
+template<int N>
+void Population<N>::evaluate(int index, FitnessCache<N> &cache) {
+    if (!cache.lookup(*this, index)) {
+        this->evaluateVector(index);
+        cache.store(*this, index);
+    }
+}
+
+/**
+ * Evaluate the individuals in [first, last) in one pass, consulting the cache first.
+ *
+ * @param first
+ * @param last
+ * @param cache
+ */
+template<int N>
+void Population<N>::evaluate(int first, int last, FitnessCache<N> &cache) {
+#pragma omp parallel for default(none) shared(first, last, cache)
+    for (int i = first; i < last; i++)
+        this->evaluate(i, cache);
+}
+
+/**
+ * Change position of two random numbers of a single individual.
+ * Only the lines through both cells and the keys of both cells are updated.
+ *
+ * @param index
+ */
+template<int N>
+void Population<N>::swap(int index) {
+    int from, to;
+    thread_local std::mt19937 rng(std::random_device{}());
+    thread_local std::uniform_int_distribution<int> dist(0, CELLS - 1);
+    Cell<N> *values = this->cells.data() + index * CELLS;
+    int *sums = this->lines.data() + index * LINES;
+
+    do {
+        from = dist(rng);
+        to = dist(rng);
+    } while (from == to);
+
+    int delta = values[to] - values[from];
+
+    this->fitness[index] += MagicSquare<N>::updateLines(sums, from / N, from % N, delta);
+    this->fitness[index] += MagicSquare<N>::updateLines(sums, to / N, to % N, -delta);
+    this->hashes[index] ^= MagicSquare<N>::zobrist(from, values[from]) ^ MagicSquare<N>::zobrist(from, values[to]) ^
+                           MagicSquare<N>::zobrist(to, values[to]) ^ MagicSquare<N>::zobrist(to, values[from]);
+
+    std::swap(values[from], values[to]);
+}
+
+/**
+ * Copy an individual of another population into given slot.
+ *
+ * @param index
+ * @param other
+ * @param from
+ */
+template<int N>
+void Population<N>::copy(int index, const Population &other, int from) {
+    std::copy_n(other.genome(from), CELLS, this->cells.data() + index * CELLS);
+    std::copy_n(other.lineSums(from), LINES, this->lines.data() + index * LINES);
+    this->fitness[index] = other.fitness[from];
+    this->hashes[index] = other.hashes[from];
+}
+
+/**
+ * Append an individual of another population or of this one.
+ * The slot is grown first and filled afterwards, so the source stays valid even if it is this population.
+ *
+ * @param other
+ * @param from
+ */
+template<int N>
+void Population<N>::push_back(const Population &other, int from) {
+    int index = this->count;
+
+    // The zeroed padding becomes the new genome, an equally sized block behind it takes over the padding
+    this->cells.resize(this->cells.size() + CELLS, 0);
+    this->lines.resize(this->lines.size() + LINES, 0);
+    this->fitness.push_back(0);
+    this->hashes.push_back(0);
+    this->count++;
+
+    this->copy(index, other, from);
+}
+
+/**
+ * Append a raw genome, it has to be evaluated before its fitness is used.
+ *
+ * @param genome
+ */
+template<int N>
+void Population<N>::push_back(const Genome<N> &genome) {
+    this->cells.insert(this->cells.begin() + this->count * CELLS, genome.begin(), genome.end());
+    this->lines.resize(this->lines.size() + LINES, 0);
+    this->fitness.push_back(0);
+    this->hashes.push_back(MagicSquare<N>::hashCells(genome.data()));
+    this->count++;
+}
+
+/**
+ * Append a single square.
+ *
+ * @param square
+ */
+template<int N>
+void Population<N>::push_back(const MagicSquare<N> &square) {
+    this->cells.insert(this->cells.begin() + this->count * CELLS, square.values.begin(), square.values.end());
+    this->lines.insert(this->lines.end(), square.lines.begin(), square.lines.end());
+    this->fitness.push_back(square.fitness);
+    this->hashes.push_back(square.hash);
+    this->count++;
+}
+
+/**
+ * Extract a single individual as magic square.
+ *
+ * @param index
+ * @return
+ */
+template<int N>
+MagicSquare<N> Population<N>::get(int index) const {
+    MagicSquare<N> square(false);
+
+    std::copy_n(this->genome(index), CELLS, square.values.begin());
+    std::copy_n(this->lineSums(index), LINES, square.lines.begin());
+    square.fitness = this->fitness[index];
+    square.hash = this->hashes[index];
+
+    return square;
+}
+
+/**
+ * Overwrite a single individual with a magic square.
+ *
+ * @param index
+ * @param square
+ */
+template<int N>
+void Population<N>::set(int index, const MagicSquare<N> &square) {
+    std::copy(square.values.begin(), square.values.end(), this->cells.data() + index * CELLS);
+    std::copy(square.lines.begin(), square.lines.end(), this->lines.data() + index * LINES);
+    this->fitness[index] = square.fitness;
+    this->hashes[index] = square.hash;
+}
+
+/**
+ * Overwrite a single individual with a raw genome, it has to be evaluated before its fitness is used.
+ *
+ * @param index
+ * @param genome
+ */
+template<int N>
+void Population<N>::set(int index, const Genome<N> &genome) {
+    std::copy(genome.begin(), genome.end(), this->cells.data() + index * CELLS);
+    this->hashes[index] = MagicSquare<N>::hashCells(genome.data());
+}
+
+/**
+ * Compare the cells of an individual with one of another population.
+ *
+ * @param index
+ * @param other
+ * @param from
+ * @return
+ */
+template<int N>
+bool Population<N>::equal(int index, const Population &other, int from) const {
+    return std::equal(this->genome(index), this->genome(index) + CELLS, other.genome(from));
+}
+
+/**
+ * Check if an individual is a rotation or reflection of one of another population.
+ *
+ * @param index
+ * @param other
+ * @param from
+ * @return
+ */
+template<int N>
+bool Population<N>::equivalent(int index, const Population &other, int from) const {
+    return MagicSquare<N>::equivalentCells(this->genome(index), other.genome(from));
+}
+
+/**
+ * Create a genome set able to hold given number of entries without growing.
+ *
+ * @param capacity
+ * @param symmetric
+ */
+template<int N>
+GenomeSet<N>::GenomeSet(int capacity, bool symmetric) : mask(0), count(0), symmetric(symmetric) {
+    this->reserve(capacity);
+}
+
+/**
+ * Remove all entries, the table itself is kept.
+ */
+template<int N>
+void GenomeSet<N>::clear() {
+    std::fill(this->entries.begin(), this->entries.end(), Entry{0, nullptr, 0});
+    this->count = 0;
+}
+
+/**
+ * Make room for given number of entries, keeping the load factor at most one half.
+ *
+ * @param capacity
+ */
+template<int N>
+void GenomeSet<N>::reserve(int capacity) {
+    std::size_t size = 16;
+
+    while (size < static_cast<std::size_t>(capacity) * 2) size *= 2;
+
+    if (size <= this->entries.size())
+        return;
+
+    std::vector<Entry> previous(size, Entry{0, nullptr, 0});
+
+    previous.swap(this->entries);
+    this->mask = size - 1;
+
+    for (auto &entry: previous)
+        if (entry.population != nullptr)
+            this->entries[this->find(*entry.population, entry.index, entry.hash)] = entry;
+}
+
+/**
+ * Hash of an individual as used by this set.
+ *
+ * @param population
+ * @param index
+ * @return
+ */
+template<int N>
+std::uint64_t GenomeSet<N>::hash(const Population<N> &population, int index) const {
+    return this->symmetric ? population.canonicalHash(index) : population.hash(index);
+}
+
+/**
+ * Find the slot holding an equal genome or the empty slot it would go to.
+ *
+ * @param population
+ * @param index
+ * @param hash
+ * @return
+ */
+template<int N>
+std::size_t GenomeSet<N>::find(const Population<N> &population, int index, std::uint64_t hash) const {
+    std::size_t slot = hash & this->mask;
+
+    while (this->entries[slot].population != nullptr) {
+        const Entry &entry = this->entries[slot];
+
+        if (entry.hash == hash && (this->symmetric ? entry.population->equivalent(entry.index, population, index)
+                                                   : entry.population->equal(entry.index, population, index)))
+            return slot;
+
+        slot = (slot + 1) & this->mask;
+    }
+
+    return slot;
+}
+
+/**
+ * Insert an individual unless an equal genome is already part of the set.
+ *
+ * @param population
+ * @param index
+ * @return true if the individual was inserted
+ */
+template<int N>
+bool GenomeSet<N>::insert(const Population<N> &population, int index) {
+    if (this->count * 2 >= static_cast<int>(this->entries.size()))
+        this->reserve(this->count + 1);
+
+    std::uint64_t hash = this->hash(population, index);
+    std::size_t slot = this->find(population, index, hash);
+
+    if (this->entries[slot].population != nullptr)
+        return false;
+
+    this->entries[slot] = Entry{hash, &population, index};
+    this->count++;
+
+    return true;
+}
+
+/**
+ * Check if an equal genome is part of the set.
+ *
+ * @param population
+ * @param index
+ * @return
+ */
+template<int N>
+bool GenomeSet<N>::contains(const Population<N> &population, int index) const {
+    return this->entries[this->find(population, index, this->hash(population, index))].population != nullptr;
+}
+
+/**
+ * Create an empty cache with given number of slots, rounded up to a power of two.
+ *
+ * @param capacity
+ */
+template<int N>
+FitnessCache<N>::FitnessCache(int capacity) : hits(0), misses(0) {
+    std::size_t size = 1;
+
+    while (size < static_cast<std::size_t>(capacity)) size *= 2;
+
+    this->mask = size - 1;
+    this->keys.assign(size, 0);
+    this->cells.assign(size * CELLS, 0);
+    this->lines.assign(size * LINES, 0);
+    this->fitness.assign(size, -1);
+    this->locks = std::vector<std::atomic_flag>(size);
+}
+
+/**
+ * Fill line sums and fitness of an individual from the cache.
+ * The cells are compared as well, so hash collisions never yield a wrong fitness.
+ *
+ * @param population
+ * @param index
+ * @return true on a hit
+ */
+template<int N>
+bool FitnessCache<N>::lookup(Population<N> &population, int index) {
+    std::uint64_t hash = population.hash(index);
+    std::size_t slot = hash & this->mask;
+    bool hit;
+
+    while (this->locks[slot].test_and_set(std::memory_order_acquire));
+
+    hit = this->fitness[slot] >= 0 && this->keys[slot] == hash &&
+          std::equal(population.genome(index), population.genome(index) + CELLS, this->cells.data() + slot * CELLS);
+
+    if (hit) {
+        std::copy_n(this->lines.data() + slot * LINES, LINES, population.lines.data() + index * LINES);
+        population.fitness[index] = this->fitness[slot];
+    }
+
+    this->locks[slot].clear(std::memory_order_release);
+
+    (hit ? this->hits : this->misses).fetch_add(1, std::memory_order_relaxed);
+
+    return hit;
+}
+
+/**
+ * Store line sums and fitness of an evaluated individual, replacing whatever occupied its slot.
+ *
+ * @param population
+ * @param index
+ */
+template<int N>
+void FitnessCache<N>::store(const Population<N> &population, int index) {
+    std::size_t slot = population.hash(index) & this->mask;
+
+    while (this->locks[slot].test_and_set(std::memory_order_acquire));
+
+    this->keys[slot] = population.hash(index);
+    std::copy_n(population.genome(index), CELLS, this->cells.data() + slot * CELLS);
+    std::copy_n(population.lineSums(index), LINES, this->lines.data() + slot * LINES);
+    this->fitness[slot] = population.getFitness(index);
+
+    this->locks[slot].clear(std::memory_order_release);
+}
+
+/**
+ * Remove an equal genome from the set, following entries are shifted back into the gap.
+ *
+ * @param population
+ * @param index
+ * @return true if a genome was removed
+ */
+template<int N>
+bool GenomeSet<N>::erase(const Population<N> &population, int index) {
+    std::size_t slot = this->find(population, index, this->hash(population, index));
+
+    if (this->entries[slot].population == nullptr)
+        return false;
+
+    this->entries[slot] = Entry{0, nullptr, 0};
+    this->count--;
+
+    for (std::size_t next = (slot + 1) & this->mask; this->entries[next].population != nullptr;
+         next = (next + 1) & this->mask) {
+        std::size_t home = this->entries[next].hash & this->mask;
+
+        // Entries whose home lies cyclically in (slot, next] already sit behind the gap
+        if (((next - home) & this->mask) >= ((next - slot) & this->mask)) {
+            this->entries[slot] = this->entries[next];
+            this->entries[next] = Entry{0, nullptr, 0};
+            slot = next;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Create an empty hall of fame.
+ *
+ * @param capacity
+ * @param symmetric
+ */
+template<int N>
+HallOfFame<N>::HallOfFame(int capacity, bool symmetric) :
+        capacity(capacity), worst(-1), archive(0, false), index(capacity, symmetric) {
+}
+
+/**
+ * Offer a square to the archive, it is kept if there is room or it beats the worst member.
+ *
+ * @param population
+ * @param from
+ * @return true if the square was added
+ */
+template<int N>
+bool HallOfFame<N>::offer(const Population<N> &population, int from) {
+    bool full = this->archive.size() >= this->capacity;
+
+    if (full && population.getFitness(from) >= this->archive.getFitness(this->worst))
+        return false;
+
+    if (this->index.contains(population, from))
+        return false;
+
+    if (full) {
+        this->index.erase(this->archive, this->worst);
+        this->archive.copy(this->worst, population, from);
+        this->index.insert(this->archive, this->worst);
+    } else {
+        this->archive.push_back(population, from);
+        this->index.insert(this->archive, this->archive.size() - 1);
+    }
+
+    this->worst = 0;
+
+    for (int i = 1; i < this->archive.size(); i++)
+        if (this->archive.getFitness(i) > this->archive.getFitness(this->worst))
+            this->worst = i;
+
+    return true;
+}
+
+/**
+ * Check if a square is a member of the archive.
+ *
+ * @param population
+ * @param from
+ * @return
+ */
+template<int N>
+bool HallOfFame<N>::contains(const Population<N> &population, int from) const {
+    return this->index.contains(population, from);
+}
+
+/**
+ * Start producing random squares into a ring of given capacity.
+ *
+ * @param capacity
+ */
+template<int N>
+ImmigrantPool<N>::ImmigrantPool(int capacity) : ring(std::max(capacity, 1), false), head(0), tail(0), stop(false) {
+    this->producer = std::thread(&ImmigrantPool::produce, this);
+}
+
+/**
+ * Stop and join the producer.
+ */
+template<int N>
+ImmigrantPool<N>::~ImmigrantPool() {
+    this->stop.store(true);
+
+    // Nothing is taken anymore, moving the head only wakes a producer waiting for room
+    this->head.fetch_add(1);
+    this->head.notify_one();
+    this->producer.join();
+}
+
+/**
+ * Keep the ring filled until stopped, waiting while it is full.
+ */
+template<int N>
+void ImmigrantPool<N>::produce() {
+    long long capacity = this->ring.size();
+
+    while (!this->stop.load(std::memory_order_relaxed)) {
+        long long head = this->head.load(std::memory_order_acquire);
+        long long tail = this->tail.load(std::memory_order_relaxed);
+
+        if (tail - head >= capacity) {
+            this->head.wait(head, std::memory_order_acquire);
+            continue;
+        }
+
+        this->ring.randomize(static_cast<int>(tail % capacity));
+        this->tail.store(tail + 1, std::memory_order_release);
+    }
+}
+
+/**
+ * Copy the next random square into a slot of a population, it arrives evaluated and hashed.
+ *
+ * @param population
+ * @param index
+ */
+template<int N>
+void ImmigrantPool<N>::take(Population<N> &population, int index) {
+    long long head = this->head.load(std::memory_order_relaxed);
+
+    if (head == this->tail.load(std::memory_order_acquire)) {
+        population.randomize(index);
+        return;
+    }
+
+    population.copy(index, this->ring, static_cast<int>(head % this->ring.size()));
+    this->head.store(head + 1, std::memory_order_release);
+    this->head.notify_one();
+}
+
+/**
+ * Build the table from non-negative weights with Vose's method in O(P).
+ *
+ * @param weights
+ */
+void AliasTable::build(const std::vector<double> &weights) {
+    int size = static_cast<int>(weights.size());
+    double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+    auto &small = this->small, &large = this->large;
+
+    small.clear();
+    large.clear();
+    this->probability.resize(size);
+    this->alias.resize(size);
+
+    for (int i = 0; i < size; i++) {
+        this->probability[i] = total > 0 ? weights[i] * size / total : 1.0;
+        this->alias[i] = i;
+        (this->probability[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    // Fill every column below one with the excess of a column above one
+    while (!small.empty() && !large.empty()) {
+        int less = small.back(), more = large.back();
+
+        small.pop_back();
+        this->alias[less] = more;
+        this->probability[more] -= 1.0 - this->probability[less];
+
+        if (this->probability[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    // Columns left over are only off by rounding errors
+    for (int i: small) this->probability[i] = 1.0;
+    for (int i: large) this->probability[i] = 1.0;
+}
+
+/**
+ * Draw an index proportional to its weight.
+ *
+ * @param rng
+ * @return
+ */
+int AliasTable::sample(std::mt19937 &rng) const {
+    std::uniform_int_distribution<int> column(0, this->size() - 1);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    int index = column(rng);
+
+    return coin(rng) < this->probability[index] ? index : this->alias[index];
+}
+
+/**
+ * Rank squares by fitness with a stable counting sort in O(P + MAX_FITNESS).
+ * The population itself is not touched, order receives the indices of the best count squares,
+ * all of them if count is not given. Every thread counts the fitness of its own chunk, so the
+ * number of threads is limited to keep the prefix sums over all histograms in O(P + MAX_FITNESS).
+ *
+ * @param population
+ * @param order
+ * @param count
+ */
+template<int N>
+void sort(const Population<N> &population, std::vector<int> &order, int count) {
+    constexpr int BUCKETS = MagicSquare<N>::MAX_FITNESS + 1;
+    int size = population.size();
+    int threads = std::min(omp_get_max_threads(), size / BUCKETS + 1);
+    thread_local std::vector<int> histograms;
+    std::vector<int> &offsets = histograms;
+
+    if (count < 0 || count > size) count = size;
+
+    order.resize(count);
+
+#pragma omp parallel num_threads(threads) default(none) shared(population, order, offsets, size, count)
+    {
+#pragma omp single
+        offsets.assign(omp_get_num_threads() * BUCKETS, 0);
+
+        int *histogram = offsets.data() + omp_get_thread_num() * BUCKETS;
+
+        // Both loops are split into the same chunks, so each thread scatters what it counted
+#pragma omp for schedule(static)
+        for (int i = 0; i < size; i++)
+            histogram[population.getFitness(i)]++;
+
+#pragma omp single
+        {
+            int teams = static_cast<int>(offsets.size()) / BUCKETS;
+            int position = 0;
+
+            for (int fitness = 0; fitness < BUCKETS; fitness++)
+                for (int team = 0; team < teams; team++) {
+                    int &offset = offsets[team * BUCKETS + fitness];
+                    int amount = offset;
+
+                    offset = position;
+                    position += amount;
+                }
+        }
+
+#pragma omp for schedule(static)
+        for (int i = 0; i < size; i++) {
+            int position = histogram[population.getFitness(i)]++;
+
+            if (position < count) order[position] = i;
+        }
+    }
+}
+
+/**
+ * Find the index of the best square in [first, last).
+ *
+ * @param population
+ * @param first
+ * @param last
+ * @return
+ */
+template<int N>
+int best(const Population<N> &population, int first, int last) {
+    if (last == -1) last = population.size();
+
+    int index = first;
+
+    for (int i = first + 1; i < last; i++)
+        if (population.getFitness(i) < population.getFitness(index))
+            index = i;
+
+    return index;
+}
+
+/**
+ * Pick a third of the population by tournaments of given size, no ranking is needed.
+ * The best square always wins the first place, every other place is won by the
+ * fittest of size random squares. Threads run their tournaments independently.
+ *
+ * @param population
+ * @param winners
+ * @param size
+ */
+template<int N>
+void tournament(const Population<N> &population, std::vector<int> &winners, int size) {
+    int count = population.size() / 3;
+
+    winners.resize(count);
+    winners[0] = best(population);
+
+#pragma omp parallel default(none) shared(population, winners, count, size)
+    {
+        thread_local std::mt19937 rng(std::random_device{}());
+        std::uniform_int_distribution<int> dist(0, population.size() - 1);
+
+#pragma omp for
+        for (int i = 1; i < count; i++) {
+            int winner = dist(rng);
+
+            for (int round = 1; round < size; round++) {
+                int challenger = dist(rng);
+
+                if (population.getFitness(challenger) < population.getFitness(winner))
+                    winner = challenger;
+            }
+
+            winners[i] = winner;
+        }
+    }
+}
+
+/**
+ * Select a third of the population, skipping duplicates.
+ * Without tournament size the best third is taken, otherwise squares are picked by tournaments.
+ * Either way selected receives the index of the best square first and every selected square is registered in unique.
+ * Genomes are not moved, the caller copies the selected squares into the slots of the next generation.
+ *
+ * @param population
+ * @param selected
+ * @param unique
+ * @param tournamentSize
+ * @return
+ */
+template<int N>
+void selection(const Population<N> &population, std::vector<int> &selected, GenomeSet<N> &unique, int tournamentSize) {
+    thread_local std::vector<int> order;
+
+    if (tournamentSize > 0) tournament(population, order, tournamentSize);
+    else sort(population, order, population.size() / 3);
+
+    selected.clear();
+
+    for (int index: order)
+        if (unique.insert(population, index))
+            selected.push_back(index);
+}
+
+/**
+ * Build the parent sampler of a population.
+ * Roulette weighs every square by the inverse of its fitness, rank by its position in the ranking.
+ *
+ * @param population
+ * @param parents
+ * @param sampling
+ */
+template<int N>
+void weigh(const Population<N> &population, AliasTable &parents, Sampling sampling) {
+    thread_local std::vector<double> weights;
+    thread_local std::vector<int> order;
+
+    weights.assign(population.size(), 1.0);
+
+    if (sampling == Sampling::ROULETTE) {
+        for (int i = 0; i < population.size(); i++)
+            weights[i] = 1.0 / (1 + population.getFitness(i));
+    } else if (sampling == Sampling::RANK) {
+        sort(population, order);
+
+        for (int rank = 0; rank < population.size(); rank++)
+            weights[order[rank]] = population.size() - rank;
+    }
+
+    parents.build(weights);
+}
+
+/**
+ * Create a child of two squares of a population, the parents are read in place.
+ * Each cell is taken from the parent whose row and column are closer to the magic sum,
+ * values that are already used are left out and filled up randomly afterwards.
+ * Used values are tracked in a bitmask, so neither step has to scan the child.
+ *
+ * @param population
+ * @param parent1
+ * @param parent2
+ * @param rng
+ * @param child
+ */
+template<int N>
+void breed(const Population<N> &population, int parent1, int parent2, std::mt19937 &rng, Genome<N> &child) {
+    // One bit per value, a single word up to 7x7 and two up to 11x11
+    std::array<std::uint64_t, N * N / 64 + 1> used{};
+    std::array<Cell<N>, N * N> missing;
+    int count = 0;
+
+    auto exists = [&used](int value) {
+        return (used[value >> 6] >> (value & 63)) & 1;
+    };
+
+    std::fill(child.begin(), child.end(), 0);
+
+    // Residuals of both parents are compared once per line, rows against columns:
+    // row1 + col1 < row2 + col2 holds exactly when row1 - row2 < col2 - col1
+    std::array<int, N> rowAdvantage;
+    std::array<int, N> colAdvantage;
+
+    for (int line = 0; line < N; line++) {
+        rowAdvantage[line] = population.fitnessRows(parent1, line) - population.fitnessRows(parent2, line);
+        colAdvantage[line] = population.fitnessColumns(parent2, line) - population.fitnessColumns(parent1, line);
+    }
+
+    // Select values based on fitness
+    for (int row = 0; row < N; ++row) {
+        for (int col = 0; col < N; ++col) {
+            int val1 = population.getValue(parent1, row, col);
+            int val2 = population.getValue(parent2, row, col);
+            int chosenValue = rowAdvantage[row] < colAdvantage[col] ? val1 : val2;
+            if (!exists(chosenValue)) {
+                child[row * N + col] = chosenValue;
+                used[chosenValue >> 6] |= std::uint64_t{1} << (chosenValue & 63);
+            }
+        }
+    }
+
+    // Fill the rest with the unused values in random order
+    for (int value = 1; value <= N * N; value++)
+        if (!exists(value)) missing[count++] = value;
+
+    std::shuffle(missing.begin(), missing.begin() + count, rng);
+
+    for (int cell = 0; cell < N * N && count > 0; cell++)
+        if (child[cell] == 0) child[cell] = missing[--count];
+}
+
+/**
+ * Draw two distinct cut points, the segment [first, last) is inherited from the first parent.
+ *
+ * @param rng
+ * @return
+ */
+template<int N>
+static std::pair<int, int> segment(std::mt19937 &rng) {
+    std::uniform_int_distribution<int> dist(0, N * N);
+    int first = dist(rng);
+    int last = dist(rng);
+
+    while (last == first) last = dist(rng);
+
+    return std::minmax(first, last);
+}
+
+/**
+ * Partially mapped crossover: a segment is copied from the first parent, the remaining cells come
+ * from the second parent, following the mapping of the segment for values already taken.
+ *
+ * @param parent1
+ * @param parent2
+ * @param rng
+ * @param child
+ */
+template<int N>
+void partiallyMapped(const Cell<N> *parent1, const Cell<N> *parent2, std::mt19937 &rng, Genome<N> &child) {
+    std::array<int, N * N + 1> position{};
+    std::array<bool, N * N + 1> inherited{};
+    auto [first, last] = segment<N>(rng);
+
+    for (int cell = 0; cell < N * N; cell++)
+        position[parent1[cell]] = cell;
+
+    for (int cell = first; cell < last; cell++) {
+        child[cell] = parent1[cell];
+        inherited[parent1[cell]] = true;
+    }
+
+    for (int cell = 0; cell < N * N; cell++) {
+        if (cell >= first && cell < last) continue;
+
+        int value = parent2[cell];
+
+        while (inherited[value]) value = parent2[position[value]];
+
+        child[cell] = value;
+    }
+}
+
+/**
+ * Order crossover: a segment is copied from the first parent, the remaining values keep their
+ * relative order in the second parent, starting behind the segment.
+ *
+ * @param parent1
+ * @param parent2
+ * @param rng
+ * @param child
+ */
+template<int N>
+void orderCrossover(const Cell<N> *parent1, const Cell<N> *parent2, std::mt19937 &rng, Genome<N> &child) {
+    std::array<bool, N * N + 1> inherited{};
+    auto [first, last] = segment<N>(rng);
+
+    for (int cell = first; cell < last; cell++) {
+        child[cell] = parent1[cell];
+        inherited[parent1[cell]] = true;
+    }
+
+    int cell = last % (N * N);
+
+    for (int offset = 0; offset < N * N; offset++) {
+        int value = parent2[(last + offset) % (N * N)];
+
+        if (inherited[value]) continue;
+
+        child[cell] = value;
+        cell = (cell + 1) % (N * N);
+    }
+}
+
+/**
+ * Cycle crossover: the cells are split into the cycles of the two parents,
+ * alternating cycles are taken from the first and the second parent, so every value keeps a parental position.
+ *
+ * @param parent1
+ * @param parent2
+ * @param rng
+ * @param child
+ */
+template<int N>
+void cycleCrossover(const Cell<N> *parent1, const Cell<N> *parent2, std::mt19937 &rng, Genome<N> &child) {
+    std::array<int, N * N + 1> position{};
+    std::array<bool, N * N> visited{};
+    // Start with a random parent, otherwise the first cell always comes from the first one
+    bool fromFirst = rng() & 1;
+
+    for (int cell = 0; cell < N * N; cell++)
+        position[parent1[cell]] = cell;
+
+    for (int start = 0; start < N * N; start++) {
+        if (visited[start]) continue;
+
+        const Cell<N> *source = fromFirst ? parent1 : parent2;
+
+        for (int cell = start; !visited[cell]; cell = position[parent2[cell]]) {
+            child[cell] = source[cell];
+            visited[cell] = true;
+        }
+
+        fromFirst = !fromFirst;
+    }
+}
+
+/**
+ * Create a child of two squares of a population with the given crossover operator.
+ *
+ * @param population
+ * @param parent1
+ * @param parent2
+ * @param rng
+ * @param child
+ * @param method
+ */
+template<int N>
+void recombine(const Population<N> &population, int parent1, int parent2, std::mt19937 &rng, Genome<N> &child,
+               Crossover method) {
+    switch (method) {
+        case Crossover::PMX:
+            partiallyMapped<N>(population.genome(parent1), population.genome(parent2), rng, child);
+            break;
+        case Crossover::OX:
+            orderCrossover<N>(population.genome(parent1), population.genome(parent2), rng, child);
+            break;
+        case Crossover::CX:
+            cycleCrossover<N>(population.genome(parent1), population.genome(parent2), rng, child);
+            break;
+        default:
+            breed(population, parent1, parent2, rng, child);
+    }
+}
+
+/**
+ * Combine squares from population, parents are drawn from the given sampler.
+ * A third of the population size is created and written into the slots of next starting at first.
+ * Offspring is left unevaluated, the caller scores it in one batch.
+ *
+ * @param population
+ * @param next
+ * @param first
+ * @param parents
+ * @param method
+ * @return number of created squares
+ */
+template<int N>
+int crossover(const Population<N> &population, Population<N> &next, int first, const AliasTable &parents,
+              Crossover method) {
+    int count = population.size() / 3;
+
+    // Every child owns the slot first + i, so threads write their offspring without any merge
+#pragma omp parallel default(none) shared(population, next, parents, method, first, count)
+    {
+        thread_local std::mt19937 rng1(std::random_device{}());
+        thread_local std::mt19937 rng2(std::random_device{}());
+        thread_local std::mt19937 rng3(std::random_device{}());
+        Genome<N> child;
+
+#pragma omp for
+        for (int i = 0; i < count; i++) {
+            int parent1 = parents.sample(rng1);
+            int parent2 = parents.sample(rng2);
+
+            // Parents are compared in place, a hash mismatch already tells them apart
+            while (population.hash(parent1) == population.hash(parent2) &&
+                   population.equal(parent1, population, parent2))
+                parent2 = parents.sample(rng2);
+
+            recombine(population, parent1, parent2, rng3, child, method);
+            next.set(first + i, child);
+        }
+    }
+
+    return count;
+}
+
+
+/**
+ * Change position of two numbers in the squares [first, last) by a given probability.
+ *
+ * @param population
+ * @param probability
+ * @param first
+ * @param last
+ */
+template<int N>
+void mutate(Population<N> &population, double probability, int first, int last) {
+    if (last == -1) last = population.size();
+
+#pragma omp parallel default(none) shared(population, probability, first, last)
+    {
+        thread_local std::mt19937 rng(std::random_device{}());
+        thread_local std::uniform_real_distribution<double> dist(0.0, 1.0);
+        // Mutate each square with a certain probability
+#pragma omp for nowait
+        for (int i = first; i < last; i++)
+            if (dist(rng) < probability)
+                population.swap(i);
+    }
+}
+
+/**
+ * Solve a magic square using given parameters.
+ * With symmetric set, rotations and reflections of a kept square count as duplicates.
+ * A tournament size above 0 replaces truncation selection with tournament selection.
+ * The selected squares of every generation are offered to a hall of fame of the best squares seen.
+ * With restart above 0 the population is rebuilt from the hall of fame and fresh squares
+ * once the best fitness hasn't improved for that many generations.
+ *
+ * @param population
+ * @param iterations
+ * @param verbose
+ * @param symmetric
+ * @param tournamentSize
+ * @param sampling
+ * @param restart
+ * @param method
+ * @return
+ */
+template<int N>
+MagicSquare<N> solve(Population<N> &population, int iterations, bool verbose, bool symmetric, int tournamentSize,
+                     Sampling sampling, int restart, Crossover method) {
+    int lastFitness = -1;
+    int unchanged = 0;
+    int bestFitness = -1;
+    int stale = 0;
+    double probability = BASE_MUTATION;
+    bool infinite = false;
+
+    if (iterations == -1) infinite = true;
+
+    // Both generations and all work buffers are allocated once up front
+    GenomeSet<N> unique(population.size(), symmetric);
+    AliasTable parents;
+    Population<N> next(population.size(), false);
+    ImmigrantPool<N> immigrants(population.size());
+    HallOfFame<N> hall(HALL_OF_FAME_SIZE, symmetric);
+    FitnessCache<N> cache;
+    std::vector<int> selected;
+
+    for (int it = 0; (it < iterations) || infinite; it++) {
+        if (restart > 0 && stale >= restart) {
+            int i = 0;
+            int members = std::min(hall.size(), population.size());
+
+            for (; i < members; i++)
+                population.copy(i, hall.members(), i);
+
+            for (; i < population.size(); i++)
+                immigrants.take(population, i);
+
+            stale = 0;
+        }
+
+        unique.clear();
+        selection(population, selected, unique, tournamentSize);
+
+        int fitness = population.getFitness(selected.front());
+
+        if (fitness == 0)
+            return population.get(selected.front());
+
+        for (int index: selected)
+            hall.offer(population, index);
+
+        if (bestFitness == -1 || fitness < bestFitness) {
+            bestFitness = fitness;
+            stale = 0;
+        } else {
+            stale++;
+        }
+
+        if (verbose) {
+            std::vector<int> top(selected);
+            int count = std::min(5, static_cast<int>(top.size()));
+
+            std::partial_sort(top.begin(), top.begin() + count, top.end(), [&population](int a, int b) {
+                return population.getFitness(a) < population.getFitness(b);
+            });
+
+            std::cout << "Current top " << count << ':' << std::endl << std::endl;
+
+            while (count > 0) {
+                std::cout << '#' << count << ':' << std::endl;
+                population.get(top[count - 1]).print();
+                count--;
+            }
+
+            std::cout << "Hall of fame: " << hall.size() << " squares, best fitness "
+                      << hall.members().getFitness(best(hall.members())) << std::endl;
+            std::cout << "Fitness cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses"
+                      << std::endl << std::endl;
+        }
+
+        // Kept squares go to the front of the next generation, the set follows them
+        int kept = static_cast<int>(selected.size());
+
+        unique.clear();
+
+        for (int i = 0; i < kept; i++) {
+            next.copy(i, population, selected[i]);
+            unique.insert(next, i);
+        }
+
+        weigh(population, parents, sampling);
+
+        int created = kept + crossover(population, next, kept, parents, method);
+
+        next.evaluate(kept, created, cache);
+
+        int fittest = best(next, kept, created);
+
+        if (next.getFitness(fittest) == 0)
+            return next.get(fittest);
+
+        if (fitness == lastFitness) {
+            unchanged++;
+
+            if (probability < 1 && unchanged >= BASE_CHANGE_COUNT) probability += 0.1;
+        } else {
+            unchanged = 0;
+            probability = BASE_MUTATION;
+        }
+
+        mutate(next, probability, kept, created);
+
+        // Offspring duplicating a square already in place is overwritten
+        int i = kept;
+        for (int j = kept; j < created; j++) {
+            if (!unique.contains(next, j)) {
+                if (i != j) next.copy(i, next, j);
+                unique.insert(next, i);
+                i++;
+            }
+        }
+
+        // Fresh squares must not duplicate any kept square
+        while (i < next.size()) {
+            immigrants.take(next, i);
+
+            if (unique.insert(next, i))
+                i++;
+        }
+
+        std::swap(population, next);
+    }
+
+    return population.get(best(population));
+}
+
+/**
+ * Solve a magic square with a steady-state algorithm.
+ * Threads keep creating single children without any barrier between them: parents are drawn uniformly
+ * or by tournaments of given size, and a child replaces the worst of a few random squares in place
+ * unless that square is fitter than the child.
+ * Every square is guarded by its own spin lock while it is read or replaced. Duplicates are rejected
+ * through a count of the hashes in the population, split into stripes with a spin lock each.
+ * One iteration stands for as many children as a generation of solve() creates.
+ *
+ * @param population
+ * @param iterations
+ * @param verbose
+ * @param symmetric
+ * @param tournamentSize
+ * @param method
+ * @return
+ */
+template<int N>
+MagicSquare<N> steadyState(Population<N> &population, int iterations, bool verbose, bool symmetric,
+                           int tournamentSize, Crossover method) {
+    const long long generation = std::max(population.size() / 3, 1);
+    const long long budget = iterations == -1 ? -1 : iterations * generation;
+    // Share of children that are random squares, as offspring and fresh squares of a generation
+    const double IMMIGRATION = 0.5;
+    // A child replaces the worst of this many random squares
+    const int REPLACEMENT = 3;
+    const int STRIPES = 64;
+    std::vector<std::atomic_flag> locks(population.size());
+    std::vector<std::atomic_flag> stripeLocks(STRIPES);
+    std::vector<std::unordered_map<std::uint64_t, int>> present(STRIPES);
+    FitnessCache<N> cache;
+    HallOfFame<N> hall(HALL_OF_FAME_SIZE, symmetric);
+    std::atomic_flag hallLock;
+    std::atomic<long long> created(0);
+    std::atomic<bool> found(false);
+    MagicSquare<N> solution(false);
+
+    auto lock = [&locks](int index) {
+        while (locks[index].test_and_set(std::memory_order_acquire));
+    };
+
+    auto unlock = [&locks](int index) {
+        locks[index].clear(std::memory_order_release);
+    };
+
+    auto key = [symmetric](const Population<N> &squares, int index) {
+        return symmetric ? squares.canonicalHash(index) : squares.hash(index);
+    };
+
+    // Count a hash unless it is already present, only then the square may enter the population
+    auto claim = [&](std::uint64_t hash) {
+        int stripe = static_cast<int>(hash % STRIPES);
+        bool fresh;
+
+        while (stripeLocks[stripe].test_and_set(std::memory_order_acquire));
+        fresh = present[stripe][hash]++ == 0;
+
+        if (!fresh) present[stripe][hash]--;
+
+        stripeLocks[stripe].clear(std::memory_order_release);
+
+        return fresh;
+    };
+
+    auto release = [&](std::uint64_t hash) {
+        int stripe = static_cast<int>(hash % STRIPES);
+
+        while (stripeLocks[stripe].test_and_set(std::memory_order_acquire));
+
+        if (--present[stripe][hash] == 0) present[stripe].erase(hash);
+
+        stripeLocks[stripe].clear(std::memory_order_release);
+    };
+
+    for (int i = 0; i < population.size(); i++)
+        present[key(population, i) % STRIPES][key(population, i)]++;
+
+    auto fitness = [&](int index) {
+        lock(index);
+        int fit = population.getFitness(index);
+        unlock(index);
+
+        return fit;
+    };
+
+    auto read = [&](int index) {
+        lock(index);
+        MagicSquare<N> square = population.get(index);
+        unlock(index);
+
+        return square;
+    };
+
+    // Copy a square into a slot of a thread's own population, so it can be read without holding its lock
+    auto snapshot = [&](Population<N> &into, int slot, int index) {
+        lock(index);
+        into.copy(slot, population, index);
+        unlock(index);
+    };
+
+    // Same output as a generation of solve(), squares are read one at a time while the others keep working
+    auto report = [&]() {
+        std::vector<std::pair<int, int>> ranking;
+        int count = std::min(5, population.size());
+
+        for (int i = 0; i < population.size(); i++)
+            ranking.emplace_back(fitness(i), i);
+
+        std::partial_sort(ranking.begin(), ranking.begin() + count, ranking.end());
+
+        std::cout << "Current top " << count << ':' << std::endl << std::endl;
+
+        while (count > 0) {
+            std::cout << '#' << count << ':' << std::endl;
+            read(ranking[count - 1].second).print();
+            count--;
+        }
+
+        while (hallLock.test_and_set(std::memory_order_acquire));
+        std::cout << "Hall of fame: " << hall.size() << " squares, best fitness "
+                  << hall.members().getFitness(best(hall.members())) << std::endl;
+        hallLock.clear(std::memory_order_release);
+
+        std::cout << "Fitness cache: " << cache.getHits() << " hits, " << cache.getMisses() << " misses"
+                  << std::endl << std::endl;
+    };
+
+    // The hall of fame is only kept for the statistics, as solve() reports it
+    auto remember = [&](const Population<N> &squares, int index) {
+        while (hallLock.test_and_set(std::memory_order_acquire));
+        hall.offer(squares, index);
+        hallLock.clear(std::memory_order_release);
+    };
+
+    for (int i = 0; i < population.size(); i++)
+        hall.offer(population, i);
+
+#pragma omp parallel default(none) shared(population, verbose, tournamentSize, generation, budget, created, found, \
+        solution, lock, unlock, key, claim, release, fitness, read, snapshot, report, remember, cache, method)
+    {
+        thread_local std::mt19937 rng(std::random_device{}());
+        thread_local std::uniform_real_distribution<double> chance(0.0, 1.0);
+        std::uniform_int_distribution<int> dist(0, population.size() - 1);
+        Population<N> child(1, false);
+        Population<N> parents(2, false);
+        Genome<N> genome{};
+
+        auto pick = [&]() {
+            int winner = dist(rng);
+            int winnerFitness = fitness(winner);
+
+            for (int round = 1; round < tournamentSize; round++) {
+                int challenger = dist(rng);
+                int challengerFitness = fitness(challenger);
+
+                if (challengerFitness < winnerFitness) {
+                    winner = challenger;
+                    winnerFitness = challengerFitness;
+                }
+            }
+
+            return winner;
+        };
+
+        while (!found.load(std::memory_order_relaxed)) {
+            long long number = created.fetch_add(1, std::memory_order_relaxed);
+
+            if (budget != -1 && number >= budget)
+                break;
+
+            if (verbose && number > 0 && number % generation == 0) {
+#pragma omp critical
+                report();
+            }
+
+            // Like the fresh squares of a generation, immigrants keep the population diverse
+            bool immigrant = chance(rng) < IMMIGRATION;
+
+            if (!immigrant) {
+                snapshot(parents, 0, pick());
+                snapshot(parents, 1, pick());
+
+                immigrant = parents.hash(0) == parents.hash(1) && parents.equal(0, parents, 1);
+
+                if (!immigrant) {
+                    recombine(parents, 0, 1, rng, genome, method);
+                    child.set(0, genome);
+                    child.evaluate(0, cache);
+
+                    if (chance(rng) < BASE_MUTATION)
+                        child.swap(0);
+                }
+            }
+
+            if (immigrant)
+                child.randomize(0);
+
+            if (child.getFitness(0) == 0) {
+#pragma omp critical
+                if (!found.load()) {
+                    solution = child.get(0);
+                    found.store(true);
+                }
+
+                break;
+            }
+
+            int victim = dist(rng);
+            int victimFitness = fitness(victim);
+
+            for (int round = 1; round < REPLACEMENT; round++) {
+                int other = dist(rng);
+                int otherFitness = fitness(other);
+
+                if (otherFitness > victimFitness) {
+                    victim = other;
+                    victimFitness = otherFitness;
+                }
+            }
+
+            // Only a worse square is replaced, a fitter victim survives the child
+            if (child.getFitness(0) > victimFitness || !claim(key(child, 0)))
+                continue;
+
+            lock(victim);
+
+            // Another thread may have replaced the victim with a better square meanwhile
+            if (population.getFitness(victim) < child.getFitness(0)) {
+                unlock(victim);
+                release(key(child, 0));
+                continue;
+            }
+
+            std::uint64_t replaced = key(population, victim);
+            population.copy(victim, child, 0);
+            unlock(victim);
+
+            release(replaced);
+            remember(child, 0);
+        }
+    }
+
+    if (found) return solution;
+
+    return population.get(best(population));
+}
+
+// Explicit instantiations for all supported square dimensions
+#define INSTANTIATE_POPULATION(N) \
+    template class Population<N>; \
+    template class FitnessCache<N>; \
+    template void sort(const Population<N> &, std::vector<int> &, int); \
+    template int best(const Population<N> &, int, int); \
+    template class GenomeSet<N>; \
+    template class HallOfFame<N>; \
+    template class ImmigrantPool<N>; \
+    template void tournament(const Population<N> &, std::vector<int> &, int); \
+    template void selection(const Population<N> &, std::vector<int> &, GenomeSet<N> &, int); \
+    template void weigh(const Population<N> &, AliasTable &, Sampling); \
+    template void breed(const Population<N> &, int, int, std::mt19937 &, Genome<N> &); \
+    template void partiallyMapped<N>(const Cell<N> *, const Cell<N> *, std::mt19937 &, Genome<N> &); \
+    template void orderCrossover<N>(const Cell<N> *, const Cell<N> *, std::mt19937 &, Genome<N> &); \
+    template void cycleCrossover<N>(const Cell<N> *, const Cell<N> *, std::mt19937 &, Genome<N> &); \
+    template void recombine(const Population<N> &, int, int, std::mt19937 &, Genome<N> &, Crossover); \
+    template int crossover(const Population<N> &, Population<N> &, int, const AliasTable &, Crossover); \
+    template void mutate(Population<N> &, double, int, int); \
+    template MagicSquare<N> solve(Population<N> &, int, bool, bool, int, Sampling, int, Crossover); \
+    template MagicSquare<N> steadyState(Population<N> &, int, bool, bool, int, Crossover);
+
+INSTANTIATE_POPULATION(3)
+INSTANTIATE_POPULATION(4)
+INSTANTIATE_POPULATION(5)
+INSTANTIATE_POPULATION(6)
+INSTANTIATE_POPULATION(7)
+INSTANTIATE_POPULATION(8)
+INSTANTIATE_POPULATION(9)
@@ -60,8 +60,20 @@ void program_options::description() {
     std::cout << "-i <number>: Iterations count (1000 - 100000 or -1 for infinite)" << std::endl;
     std::cout.width(31);
     std::cout << "-o <name>: Output file name" << std::endl;
+    std::cout.width(72);
+    std::cout << "-r <number>: Restart after generations without improvement (0 = never)" << std::endl;
+    std::cout.width(63);
+    std::cout << "-sel <mode>: Selection mode (truncation or tournament:<size>)" << std::endl;
+    std::cout.width(58);
+    std::cout << "-par <mode>: Parent sampling (uniform, roulette or rank)" << std::endl;
+    std::cout.width(58);
+    std::cout << "-x <mode>: Crossover operator (fittest, pmx, ox or cx)" << std::endl;
+    std::cout.width(46);
+    std::cout << "-e <engine>: Engine (generational or steady)" << std::endl;
     std::cout.width(26);
     std::cout << "-s: Silent mode" << std::endl;
+    std::cout.width(60);
+    std::cout << "-c: Treat rotations and reflections as duplicates" << std::endl;
     std::cout.width(27);
     std::cout << "-v: Verbose mode" << std::endl;
     std::cout.width(19);
@@ -0,0 +1,44 @@
+#include <cmath>
+#include <iostream>
+
+#include "population.h"
+
+const int DRAWS = 1000000;
+
+/**
+ * Compare the frequencies drawn from an alias table against its weights.
+ *
+ * @param weights
+ * @return
+ */
+bool check(const std::vector<double> &weights) {
+    std::mt19937 rng(42);
+    AliasTable table;
+    std::vector<int> counts(weights.size(), 0);
+    double total = 0;
+
+    table.build(weights);
+
+    for (int i = 0; i < DRAWS; i++)
+        counts[table.sample(rng)]++;
+
+    for (double weight: weights)
+        total += weight;
+
+    for (std::size_t i = 0; i < weights.size(); i++)
+        if (std::abs(counts[i] - DRAWS * weights[i] / total) > 0.01 * DRAWS) {
+            std::cout << "Wrong frequency of index " << i << std::endl;
+            return false;
+        }
+
+    return true;
+}
+
+int main() {
+    bool success = check({1, 1, 1, 1}) &&
+                   check({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}) &&
+                   check({0, 5, 0, 1, 0.5}) &&
+                   check({1.0 / 1, 1.0 / 13, 1.0 / 40, 1.0 / 2, 1.0 / 7});
+
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,38 @@
+#include <algorithm>
+#include <iostream>
+
+#include "dimensions.h"
+#include "population.h"
+
+const int POPULATION = 1000;
+
+/**
+ * Compare the batch evaluation of a population against the scalar kernel.
+ *
+ * @return
+ */
+template<int N>
+bool check() {
+    Population<N> population(POPULATION);
+    int lines[MagicSquare<N>::LINES];
+
+    // Grow the population once more to cover individuals appended behind the padding
+    population.push_back(population, 0);
+    population.evaluate();
+
+    for (int i = 0; i < population.size(); i++) {
+        int fitness = MagicSquare<N>::evaluateLines(population.genome(i), lines);
+
+        if (fitness != population.getFitness(i) ||
+            !std::equal(lines, lines + MagicSquare<N>::LINES, population.lineSums(i))) {
+            std::cout << "Wrong batch evaluation" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+#include "dimensions.h"
+#include "population.h"
+
+const int ROUNDS = 1000;
+
+/**
+ * Every child has to be a permutation of 1..N*N, a square bred with itself has to be reproduced.
+ * Cycle crossover additionally keeps every value at the position of one of the parents.
+ *
+ * @param method
+ * @return
+ */
+template<int N>
+bool check(Crossover method) {
+    std::mt19937 rng(42);
+    Genome<N> child{};
+
+    for (int round = 0; round < ROUNDS; round++) {
+        Population<N> parents(2);
+        std::array<bool, N * N + 1> seen{};
+
+        recombine(parents, 0, 1, rng, child, method);
+
+        for (int cell = 0; cell < N * N; cell++) {
+            if (child[cell] < 1 || child[cell] > N * N || seen[child[cell]]) {
+                std::cout << "Child is no permutation" << std::endl;
+                return false;
+            }
+
+            if (method == Crossover::CX && child[cell] != parents.getValue(0, cell / N, cell % N) &&
+                child[cell] != parents.getValue(1, cell / N, cell % N)) {
+                std::cout << "Child value of cycle crossover at no parental position" << std::endl;
+                return false;
+            }
+
+            seen[child[cell]] = true;
+        }
+
+        recombine(parents, 0, 0, rng, child, method);
+
+        for (int cell = 0; cell < N * N; cell++) {
+            if (child[cell] != parents.getValue(0, cell / N, cell % N)) {
+                std::cout << "Child differs from its only parent" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template<int N>
+bool check() {
+    return check<N>(Crossover::FITTEST) && check<N>(Crossover::PMX) && check<N>(Crossover::OX) &&
+           check<N>(Crossover::CX);
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}
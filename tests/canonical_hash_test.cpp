@@ -0,0 +1,44 @@
+#include <iostream>
+
+#include "dimensions.h"
+#include "magic_square.h"
+
+const int SQUARES = 100;
+
+/**
+ * Check that all rotations and reflections of a square share its canonical hash.
+ *
+ * @return
+ */
+template<int N>
+bool check() {
+    for (int i = 0; i < SQUARES; i++) {
+        MagicSquare<N> square;
+
+        for (const auto &cells: SYMMETRY_CELLS<N>) {
+            MagicSquare<N> symmetric(false);
+
+            for (int cell = 0; cell < N * N; cell++)
+                symmetric.setValue(cells[cell] / N, cells[cell] % N, square.getValue(cell / N, cell % N));
+
+            if (symmetric.getCanonicalHash() != square.getCanonicalHash() ||
+                symmetric.getFitness() != square.getFitness() || !symmetric.equivalent(square)) {
+                std::cout << "Wrong canonical hash" << std::endl;
+                return false;
+            }
+        }
+
+        MagicSquare<N> other;
+
+        if (other.equivalent(square) != (other.getCanonicalHash() == square.getCanonicalHash())) {
+            std::cout << "Wrong equivalence" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}
@@ -0,0 +1,40 @@
+#ifndef PERFECT_MAGIC_SQUARE_DIMENSIONS_H
+#define PERFECT_MAGIC_SQUARE_DIMENSIONS_H
+
+#include <cstdlib>
+#include <iostream>
+
+#include "magic_square.h"
+
+/**
+ * Run a check for every supported square dimension, stopping at the first one that fails.
+ * The check is a generic lambda taking the dimension as template parameter.
+ *
+ * @param check
+ * @return true if the check passed for all dimensions
+ */
+template<int N = MIN_DIMENSION, typename Check>
+bool checkDimensions(const Check &check) {
+    if (!check.template operator()<N>()) {
+        std::cout << "Failed for size " << N << std::endl;
+        return false;
+    }
+
+    if constexpr (N < MAX_DIMENSION)
+        return checkDimensions<N + 1>(check);
+
+    return true;
+}
+
+/**
+ * Exit code of a unit test running a check for every supported square dimension.
+ *
+ * @param check
+ * @return
+ */
+template<typename Check>
+int testDimensions(const Check &check) {
+    return checkDimensions(check) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif //PERFECT_MAGIC_SQUARE_DIMENSIONS_H
@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <iostream>
+
+#include "dimensions.h"
+#include "population.h"
+
+const int POPULATION = 1000;
+
+/**
+ * Evaluate a population twice through the cache, every result has to match the direct evaluation.
+ * The first pass must miss on all squares, the second one must hit on all of them.
+ *
+ * @return
+ */
+template<int N>
+bool check() {
+    Population<N> population(POPULATION);
+    FitnessCache<N> cache(POPULATION * 64);
+    int lines[MagicSquare<N>::LINES];
+
+    for (int pass = 1; pass <= 2; pass++) {
+        population.evaluate(0, population.size(), cache);
+
+        for (int i = 0; i < population.size(); i++) {
+            int fitness = MagicSquare<N>::evaluateLines(population.genome(i), lines);
+
+            if (fitness != population.getFitness(i) ||
+                !std::equal(lines, lines + MagicSquare<N>::LINES, population.lineSums(i))) {
+                std::cout << "Wrong cached evaluation" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Random squares practically never collide, colliding slots are simply replaced
+    if (cache.getMisses() < POPULATION || cache.getHits() + cache.getMisses() != 2 * POPULATION ||
+        cache.getHits() < POPULATION * 9 / 10) {
+        std::cout << "Wrong cache statistics: " << cache.getHits() << " hits, "
+                  << cache.getMisses() << " misses" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <iostream>
+
+#include "dimensions.h"
+#include "population.h"
+
+const int POPULATION = 1000;
+const int CAPACITY = 50;
+const int ITERATIONS = 100;
+
+/**
+ * Offer a population to a hall of fame and check that exactly its best squares are kept.
+ *
+ * @return
+ */
+template<int N>
+bool check() {
+    Population<N> population(POPULATION);
+    HallOfFame<N> hall(CAPACITY);
+    std::vector<int> order;
+    std::vector<int> expected, kept;
+
+    for (int i = 0; i < population.size(); i++)
+        hall.offer(population, i);
+
+    // Offering everything again must neither add nor replace a member
+    for (int i = 0; i < population.size(); i++)
+        if (hall.offer(population, i)) {
+            std::cout << "Duplicate entered hall of fame" << std::endl;
+            return false;
+        }
+
+    sort(population, order);
+
+    // Small random populations may hold the same square twice, the hall keeps it only once
+    GenomeSet<N> distinct(population.size());
+
+    for (int i: order)
+        if (static_cast<int>(expected.size()) < CAPACITY && distinct.insert(population, i))
+            expected.push_back(population.getFitness(i));
+    for (int i = 0; i < hall.size(); i++) kept.push_back(hall.members().getFitness(i));
+
+    std::sort(kept.begin(), kept.end());
+
+    if (kept != expected) {
+        std::cout << "Wrong hall of fame" << std::endl;
+        return false;
+    }
+
+    // Every member is found after all the replacements, the rest of the population only if equal
+    for (int i = 0; i < hall.size(); i++)
+        if (!hall.contains(hall.members(), i)) {
+            std::cout << "Lost member of hall of fame" << std::endl;
+            return false;
+        }
+
+    for (int i = 0; i < population.size(); i++)
+        if (population.getFitness(i) > expected.back() && hall.contains(population, i)) {
+            std::cout << "Wrong member of hall of fame" << std::endl;
+            return false;
+        }
+
+    // A restart must not copy more members than a population smaller than the hall of fame holds
+    Population<N> small(HALL_OF_FAME_SIZE / 4);
+
+    solve(small, ITERATIONS, false, false, 0, Sampling::UNIFORM, 1);
+
+    if (small.size() != HALL_OF_FAME_SIZE / 4) {
+        std::cout << "Restart resized a small population" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}
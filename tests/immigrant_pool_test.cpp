@@ -0,0 +1,42 @@
+#include <algorithm>
+#include <iostream>
+
+#include "dimensions.h"
+#include "population.h"
+
+const int POPULATION = 1000;
+const int ROUNDS = 5;
+
+/**
+ * Check that squares taken from the pool are evaluated and hashed random permutations.
+ *
+ * @return
+ */
+template<int N>
+bool check() {
+    ImmigrantPool<N> immigrants(POPULATION / 10);
+    Population<N> population(POPULATION, false);
+    int lines[MagicSquare<N>::LINES];
+
+    for (int round = 0; round < ROUNDS; round++)
+        for (int i = 0; i < population.size(); i++) {
+            Genome<N> values;
+
+            immigrants.take(population, i);
+            std::copy_n(population.genome(i), N * N, values.begin());
+            std::sort(values.begin(), values.end());
+
+            if (values.front() != 1 || std::adjacent_find(values.begin(), values.end()) != values.end() ||
+                MagicSquare<N>::evaluateLines(population.genome(i), lines) != population.getFitness(i) ||
+                MagicSquare<N>::hashCells(population.genome(i)) != population.hash(i)) {
+                std::cout << "Wrong immigrant" << std::endl;
+                return false;
+            }
+        }
+
+    return true;
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+#include "dimensions.h"
+#include "population.h"
+
+const int POPULATION = 10000;
+
+/**
+ * Compare the counting sort ranking against a stable comparison sort.
+ *
+ * @return
+ */
+template<int N>
+bool check() {
+    Population<N> population(POPULATION);
+    std::vector<int> order, expected(population.size()), best;
+
+    // Zero squares reach fitness values no permutation can have
+    population.resize(population.size() + 10);
+    expected.resize(population.size());
+
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(), [&population](int a, int b) {
+        return population.getFitness(a) < population.getFitness(b);
+    });
+
+    sort(population, order);
+    sort(population, best, population.size() / 3);
+
+    if (order != expected || !std::equal(best.begin(), best.end(), expected.begin()) ||
+        static_cast<int>(best.size()) != population.size() / 3) {
+        std::cout << "Wrong ranking" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}
@@ -5,7 +5,7 @@
 #include <iostream>
 #include <vector>
 
-#include "magic_square.h"
+#include "population.h"
 #include "program_options.h"
 
 const int POPULATION = 10000;
@@ -15,12 +15,10 @@ const int ITERATIONS = 10000;
 int main(int argc, char **argv) {
     const std::vector<std::string_view> args(argv, argv + argc);
     bool verbose = program_options::has(args, "-v");
-    std::vector<MagicSquare> population;
+    Population<SIZE> population(POPULATION);
     std::string name("result_5.csv");
 
-    for (int i = 0; i < POPULATION; i++) population.emplace_back(SIZE);
-
-    auto square = solve(population, SIZE, ITERATIONS, verbose);
+    auto square = solve(population, ITERATIONS, verbose);
 
     if (square.getFitness() == 0) {
         std::cout << "Found solution:" << std::endl;
@@ -0,0 +1,28 @@
+#include <iostream>
+#include <vector>
+
+#include "population.h"
+#include "program_options.h"
+
+const int POPULATION = 1000;
+const int SIZE = 4;
+const int ITERATIONS = 10000;
+
+int main(int argc, char **argv) {
+    const std::vector<std::string_view> args(argv, argv + argc);
+    bool verbose = program_options::has(args, "-v");
+    Population<SIZE> population(POPULATION);
+
+    auto square = steadyState(population, ITERATIONS, verbose);
+
+    if (square.getFitness() == 0) {
+        std::cout << "Found solution:" << std::endl;
+        square.print(false);
+
+        return EXIT_SUCCESS;
+    }
+
+    std::cout << "No solution found!" << std::endl;
+
+    return EXIT_FAILURE;
+}
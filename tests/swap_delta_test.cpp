@@ -0,0 +1,44 @@
+#include <iostream>
+
+#include "dimensions.h"
+#include "magic_square.h"
+
+const int SQUARES = 100;
+
+/**
+ * Compare every swap delta against a full re-evaluation of the swapped square.
+ *
+ * @return
+ */
+template<int N>
+bool check() {
+    for (int i = 0; i < SQUARES; i++) {
+        MagicSquare<N> square;
+
+        for (int from = 0; from < N * N; from++)
+            for (int to = from + 1; to < N * N; to++) {
+                int delta = square.evaluateSwapDelta(from / N, from % N, to / N, to % N);
+                MagicSquare<N> swapped = square;
+
+                swapped.applySwap(from / N, from % N, to / N, to % N);
+
+                if (swapped.getFitness() != square.getFitness() + delta) {
+                    std::cout << "Wrong incremental fitness" << std::endl;
+                    return false;
+                }
+
+                swapped.evaluate();
+
+                if (swapped.getFitness() != square.getFitness() + delta) {
+                    std::cout << "Wrong swap delta" << std::endl;
+                    return false;
+                }
+            }
+    }
+
+    return true;
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}
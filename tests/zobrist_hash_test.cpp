@@ -0,0 +1,47 @@
+#include <iostream>
+
+#include "dimensions.h"
+#include "population.h"
+
+const int POPULATION = 100;
+const int SWAPS = 1000;
+
+/**
+ * Compare incrementally maintained hashes against hashes recomputed from the cells.
+ *
+ * @return
+ */
+template<int N>
+bool check() {
+    MagicSquare<N> square;
+    Population<N> population(POPULATION);
+
+    for (int i = 0; i < SWAPS; i++) {
+        MagicSquare<N> previous = square;
+
+        square.swap();
+
+        if (square.getHash() != MagicSquare<N>::hashCells(square.getValues().data()) ||
+            square.getHash() == previous.getHash() || square == previous) {
+            std::cout << "Wrong square hash" << std::endl;
+            return false;
+        }
+    }
+
+    for (int i = 0; i < POPULATION; i++) {
+        for (int j = 0; j < SWAPS / POPULATION; j++)
+            population.swap(i);
+
+        if (population.hash(i) != MagicSquare<N>::hashCells(population.genome(i)) ||
+            population.hash(i) != population.get(i).getHash()) {
+            std::cout << "Wrong population hash" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    return testDimensions([]<int N>() { return check<N>(); });
+}